@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Storage for the small structs passed as user data to LVGL event and timer callbacks. The arena
+// lives inside the screen object that registers the callbacks, so every context goes away with
+// the screen in one go and nothing is allocated on the heap.
+//
+// Contexts are never destroyed individually, which is why they must be trivially destructible:
+// point at strings and objects the screen already owns instead of copying them.
+template<size_t Capacity>
+class CallbackArena
+{
+public:
+	CallbackArena() = default;
+
+	CallbackArena(const CallbackArena&) = delete;
+	CallbackArena& operator=(const CallbackArena&) = delete;
+
+	// Returns nullptr once Capacity is exhausted.
+	template<typename T, typename... Args>
+	T* make(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "Arena contexts are never destroyed");
+
+		const size_t offset = (m_used + alignof(T) - 1) & ~(alignof(T) - 1);
+
+		if (offset + sizeof(T) > Capacity)
+			return nullptr;
+
+		m_used = offset + sizeof(T);
+
+		return new (m_storage.data() + offset) T { std::forward<Args>(args)... };
+	}
+
+	size_t used() const
+	{
+		return m_used;
+	}
+
+private:
+	alignas(std::max_align_t) std::array<uint8_t, Capacity> m_storage;
+	size_t m_used = 0;
+};
@@ -1,33 +1,35 @@
 #include "EspressoBrewTab.hpp"
+#include "EspressoLayout.hpp"
+#include "EspressoTheme.hpp"
 #include "Settings/SettingsManager.hpp"
 
 namespace
 {
-	static lv_style_t style_title;
-	static lv_style_t style_bullet;
-
 	constexpr int kTimerPeriodMs = 100;
+	constexpr int kTelemetryPeriodMs = 20;
+
+	// Shot logs get every sample, the plot keeps one point per kPlotPeriodMs
+	constexpr uint32_t kSamplePeriodMs = 20;
+	constexpr uint32_t kPlotPeriodMs = 100;
+	constexpr uint32_t kSamplesPerPlotPoint = kPlotPeriodMs / kSamplePeriodMs;
 	constexpr int kShotTimeSec = 30;
 	constexpr int kArcMax = (1000 / kTimerPeriodMs) * kShotTimeSec + 1;
 	constexpr int kArcAngleIncrement = std::max(1, 360 / (kArcMax));
 
+	constexpr EspressoLayout kLayout = EspressoLayout::get();
+	constexpr auto kBrew = kLayout.brew;
+
 	struct TimerData
 	{
 		bool* timerRunning;
 
-		float* pressure;
-		float* temperature;
-
 		uint64_t* time;
+		uint64_t arcSteps;
 
 		lv_obj_t* resetSwitch;
 		lv_obj_t* arc;
-		lv_obj_t* chart;
-
-		lv_chart_series_t* chartPressureSeries;
-		lv_chart_series_t* chartTemperatureSeries;
 
-		Logging* shotLog;
+		LabelBinding* stopwatchText;
 	};
 
 	struct ResetSwitchData
@@ -36,6 +38,8 @@ namespace
 		lv_obj_t* arc;
 		lv_timer_t* timer;
 		uint64_t* time;
+		LabelBinding* arcText;
+		EspressoLivePlot* plot;
 	};
 
 	struct TimerSwitchData
@@ -46,44 +50,44 @@ namespace
 		Logging* log;
 	};
 
-	static void timer_cb(lv_timer_t* t)
+	static void advance_arc(lv_obj_t* arc)
 	{
-		auto data = static_cast<TimerData*>(t->user_data);
-
-		auto dataPoint = std::make_pair(*data->temperature, *data->pressure * 20);
-
-		const auto& [temperature, pressure] = dataPoint;
-
-		lv_chart_set_next_value(data->chart, data->chartTemperatureSeries, temperature);
-		lv_chart_set_next_value(data->chart, data->chartPressureSeries, pressure);
-
-		if (! *data->timerRunning)
-			return;
-
-		data->shotLog->AddData(dataPoint);
-
-		(*data->time) += kTimerPeriodMs;
-
-		auto* label = lv_obj_get_child(data->arc, 0);
-
-		if (auto val = lv_arc_get_value(data->arc); val < kArcMax)
+		if (auto val = lv_arc_get_value(arc); val < kArcMax)
 		{
-			lv_arc_set_value(data->arc, val + 1);
+			lv_arc_set_value(arc, val + 1);
 		}
 		else
 		{
-			if (auto angle = lv_arc_get_angle_start(data->arc) + kArcAngleIncrement; angle < 360)
+			if (auto angle = lv_arc_get_angle_start(arc) + kArcAngleIncrement; angle < 360)
 			{
-				lv_arc_set_start_angle(data->arc, angle);
+				lv_arc_set_start_angle(arc, angle);
 			}
 			else
 			{
-				lv_arc_set_value(data->arc, 0);
-				lv_arc_set_start_angle(data->arc, 0);
+				lv_arc_set_value(arc, 0);
+				lv_arc_set_start_angle(arc, 0);
 			}
 		}
+	}
+
+	static void timer_cb(lv_timer_t* t)
+	{
+		auto data = static_cast<TimerData*>(t->user_data);
+
+		if (! *data->timerRunning)
+			return;
+
+		// time follows the sample timestamps, so a late tick moves the arc on by every step it missed
+		const uint64_t steps = *data->time / kTimerPeriodMs;
 
-		lv_label_set_text_fmt(label, "%u", static_cast<uint>(*data->time / 1000));
+		if (steps < data->arcSteps)
+			data->arcSteps = 0;
+
+		for (; data->arcSteps < steps; ++data->arcSteps)
+			advance_arc(data->arc);
+
+		// Only reaches LVGL once a second, when the displayed value changes
+		data->stopwatchText->setValue(static_cast<float>(*data->time / 1000));
 	}
 
 
@@ -98,10 +102,12 @@ namespace
 		*(data.time) = 0;
 
 		// set arclabel to boiler state
-		auto label = lv_obj_get_child(data.arc, 0);
-		lv_label_set_text(label, "Ready");
+		data.arcText->setText("Ready");
 		lv_arc_set_value(data.arc, 0);
 
+		// next shot starts at full detail on an empty plot
+		data.plot->clear();
+
 		// set timer switch label to start and unchecked
 		lv_obj_clear_state(data.switch1, LV_STATE_CHECKED);
 		lv_label_set_text(lv_obj_get_child(data.switch1, 0), "Start");
@@ -139,16 +145,32 @@ namespace
 		}
 	}
 
-	static lv_obj_t* create_meter_box(lv_obj_t* parent)
+	static void style_gauge_layer(lv_obj_t* meter)
+	{
+		/*Add a special circle to the needle's pivot*/
+		lv_obj_add_style(meter, EspressoTheme::needlePivot(), LV_PART_INDICATOR);
+		lv_obj_add_style(meter, EspressoTheme::text(EspressoTheme::Text::Scale), 0);
+	}
+
+	static std::unique_ptr<EspressoGauge> create_gauge(lv_obj_t* parent)
 	{
-		lv_obj_t* meter = lv_meter_create(parent);
-		lv_obj_remove_style(meter, nullptr, LV_PART_MAIN);
+		auto gauge = std::make_unique<EspressoGauge>(parent, kBrew.gaugeSize);
 
-		lv_obj_t* label1 = lv_label_create(meter);
-		lv_obj_set_style_text_font(label1, &lv_font_montserrat_16, 0);
-		lv_obj_set_pos(label1, 45, 115);
+		style_gauge_layer(gauge->scaleMeter());
+		style_gauge_layer(gauge->needleMeter());
 
-		return meter;
+		// Value label sits on the needle layer so it is drawn over the cached scale
+		lv_obj_t* label1 = lv_label_create(gauge->needleMeter());
+		lv_obj_add_style(label1, EspressoTheme::text(EspressoTheme::Text::Body), 0);
+		lv_obj_set_pos(label1, kBrew.gaugeLabelX, kBrew.gaugeLabelY);
+
+		return gauge;
+	}
+
+	static void telemetry_timer_cb(lv_timer_t* t)
+	{
+		auto tab = static_cast<EspressoBrewTab*>(t->user_data);
+		tab->processTelemetry();
 	}
 
 	void lvgl_event_callback(lv_event_t* e)
@@ -164,7 +186,7 @@ namespace
 
 		lv_slider_set_range(slider, range.first, range.second/3);
 		lv_slider_set_value(slider, static_cast<int>(initial), LV_ANIM_OFF);
-		lv_obj_set_size(slider, 330, 15);
+		lv_obj_set_size(slider, kBrew.sliderWidth, kBrew.sliderHeight);
 		lv_obj_center(slider);
 
 		return slider;
@@ -190,132 +212,192 @@ namespace
 }
 
 EspressoBrewTab::EspressoBrewTab(lv_obj_t* parent, BoilerController* boiler, ScalesController* scales)
-	: m_shotLogger(false, "shot")
+	: m_parent(parent)
+	, m_currentTempTelemetry(TelemetryBus::get().boilerCurrentTemp)
+	, m_targetTempTelemetry(TelemetryBus::get().boilerTargetTemp)
+	, m_pressureTelemetry(TelemetryBus::get().boilerPressure)
+	, m_stateTelemetry(TelemetryBus::get().boilerState)
+	, m_weightTelemetry(TelemetryBus::get().scalesWeight)
+	, m_sampler(TelemetryBus::get(), kSamplePeriodMs)
+	, m_sampleTelemetry(m_sampler.samples)
 	, m_boilerController(boiler)
 	, m_scalesController(scales)
+	, m_shotLogger(m_store, false, "shot", Logging::WriteMode::Background, Logging::FileFormat::Binary, kSamplePeriodMs)
 {
 	lv_group_init();
 
 	lv_obj_set_flex_flow(parent, LV_FLEX_FLOW_ROW_WRAP);
 
-	lv_style_init(&style_title);
-	lv_style_set_text_font(&style_title, LV_FONT_DEFAULT);
+	lv_obj_add_style(parent, EspressoTheme::tabPage(), 0);
 
-	lv_style_init(&style_bullet);
-	lv_style_set_border_width(&style_bullet, 0);
-	lv_style_set_radius(&style_bullet, LV_RADIUS_CIRCLE);
-	lv_obj_set_style_pad_row(parent, 10, 0);
+	static constexpr lv_coord_t cont_grid_col_dsc[] =
+		{kBrew.panelWidth, kBrew.panelWidth, LV_GRID_TEMPLATE_LAST};
+	static constexpr lv_coord_t cont_grid_row_dsc[] =
+		{kBrew.gaugeRowHeight, kBrew.readoutHeight, kBrew.controlsHeight, LV_GRID_TEMPLATE_LAST};
 
-	// Panel 1 -- Temperature Gauge
-	lv_obj_t* cont = lv_obj_create(parent);
-	lv_obj_set_size(cont, 370, 180);
-	lv_obj_set_style_pad_row(cont, 0, 0);
-	lv_obj_set_style_pad_column(cont, 20, 0);
+	lv_obj_set_grid_dsc_array(parent, cont_grid_col_dsc, cont_grid_row_dsc);
+}
 
-	m_meter1 = create_meter_box(cont);
+bool EspressoBrewTab::buildStep()
+{
+	switch (m_buildStage++)
+	{
+	case 0:
+		buildTemperatureGauge();
+		return false;
+
+	case 1:
+		buildPressureGauge();
+		return false;
+
+	// Scales are final, render them into their cached images once
+	case 2:
+		m_tempGauge->refresh();
+		return false;
+
+	case 3:
+		m_pressureGauge->refresh();
+		return false;
+
+	case 4:
+		buildChart();
+		return false;
+
+	// Lays out the chart, allocates the canvas and fills its background
+	case 5:
+		buildPlot();
+		return false;
+
+	case 6:
+		buildStopwatch();
+		return false;
+
+	case 7:
+		buildReadouts();
+		return true;
+
+	default:
+		return true;
+	}
+}
 
-	/*Add a special circle to the needle's pivot*/
-	lv_obj_set_style_size(m_meter1, 4, LV_PART_INDICATOR);
-	lv_obj_set_style_radius(m_meter1, LV_RADIUS_CIRCLE, LV_PART_INDICATOR);
-	lv_obj_set_style_bg_opa(m_meter1, LV_OPA_COVER, LV_PART_INDICATOR);
-	lv_obj_set_style_bg_color(m_meter1, lv_palette_darken(LV_PALETTE_GREY, 4), LV_PART_INDICATOR);
-	lv_obj_set_style_text_font(m_meter1, &lv_font_montserrat_12, 0);
+void EspressoBrewTab::buildTemperatureGauge()
+{
+	// Panel 1 -- Temperature Gauge
+	m_gaugePanel = lv_obj_create(m_parent);
+	lv_obj_set_size(m_gaugePanel, kBrew.panelWidth, kBrew.gaugeRowHeight);
+	lv_obj_add_style(m_gaugePanel, EspressoTheme::gaugePanel(), 0);
+	lv_obj_clear_flag(m_gaugePanel, LV_OBJ_FLAG_SCROLLABLE);
 
-	lv_meter_scale_t* scale = lv_meter_add_scale(m_meter1);
-	lv_meter_set_scale_ticks(m_meter1, scale, 41, 1, 8, lv_palette_main(LV_PALETTE_GREY));
-	lv_meter_set_scale_major_ticks(m_meter1, scale, 8, 2, 8, lv_color_black(), 10);
+	m_tempGauge = create_gauge(m_gaugePanel);
+	lv_obj_t* meter1 = m_tempGauge->scaleMeter();
 
-	lv_meter_set_scale_range(m_meter1, scale, 0, 200, 270, 135);
+	lv_meter_scale_t* scale = lv_meter_add_scale(meter1);
+	lv_meter_set_scale_ticks(meter1, scale, 41, 1, 8, lv_palette_main(LV_PALETTE_GREY));
+	lv_meter_set_scale_major_ticks(meter1, scale, 8, 2, 8, lv_color_black(), 10);
 
+	lv_meter_set_scale_range(meter1, scale, 0, 200, 270, 135);
+
+	lv_meter_scale_t* tempNeedleScale = m_tempGauge->addNeedleScale(0, 200, 270, 135);
 	m_indic[indic_temp] =
-		lv_meter_add_needle_line(m_meter1, scale, 2, lv_palette_main(LV_PALETTE_RED), -10);
+		lv_meter_add_needle_line(m_tempGauge->needleMeter(), tempNeedleScale, 2, lv_palette_main(LV_PALETTE_RED), -10);
 	m_indic[indic_arc] =
-		lv_meter_add_arc(m_meter1, scale, 3, lv_palette_main(LV_PALETTE_GREEN), 0);
+		lv_meter_add_arc(meter1, scale, 3, lv_palette_main(LV_PALETTE_GREEN), 0);
 
-	lv_meter_indicator_t* indic = lv_meter_add_arc(m_meter1, scale, 2, lv_palette_main(LV_PALETTE_BLUE), 0);
-	lv_meter_set_indicator_start_value(m_meter1, indic, 0);
-	lv_meter_set_indicator_end_value(m_meter1, indic, 40);
+	lv_meter_indicator_t* indic = lv_meter_add_arc(meter1, scale, 2, lv_palette_main(LV_PALETTE_BLUE), 0);
+	lv_meter_set_indicator_start_value(meter1, indic, 0);
+	lv_meter_set_indicator_end_value(meter1, indic, 40);
 
-	indic = lv_meter_add_scale_lines(m_meter1,
+	indic = lv_meter_add_scale_lines(meter1,
 		scale,
 		lv_palette_main(LV_PALETTE_BLUE),
 		lv_palette_main(LV_PALETTE_BLUE),
 		false,
 		0);
-	lv_meter_set_indicator_start_value(m_meter1, indic, 0);
-	lv_meter_set_indicator_end_value(m_meter1, indic, 40);
+	lv_meter_set_indicator_start_value(meter1, indic, 0);
+	lv_meter_set_indicator_end_value(meter1, indic, 40);
 
-	indic = lv_meter_add_arc(m_meter1, scale, 2, lv_palette_main(LV_PALETTE_RED), 0);
-	lv_meter_set_indicator_start_value(m_meter1, indic, 160);
-	lv_meter_set_indicator_end_value(m_meter1, indic, 200);
+	indic = lv_meter_add_arc(meter1, scale, 2, lv_palette_main(LV_PALETTE_RED), 0);
+	lv_meter_set_indicator_start_value(meter1, indic, 160);
+	lv_meter_set_indicator_end_value(meter1, indic, 200);
 
-	indic = lv_meter_add_scale_lines(m_meter1,
+	indic = lv_meter_add_scale_lines(meter1,
 		scale,
 		lv_palette_main(LV_PALETTE_RED),
 		lv_palette_main(LV_PALETTE_RED),
 		false,
 		0);
-	lv_meter_set_indicator_start_value(m_meter1, indic, 160);
-	lv_meter_set_indicator_end_value(m_meter1, indic, 200);
+	lv_meter_set_indicator_start_value(meter1, indic, 160);
+	lv_meter_set_indicator_end_value(meter1, indic, 200);
 
-	indic = lv_meter_add_scale_lines(m_meter1,
+	indic = lv_meter_add_scale_lines(meter1,
 		scale,
 		lv_palette_main(LV_PALETTE_RED),
 		lv_palette_main(LV_PALETTE_RED),
 		false,
 		0);
-	lv_meter_set_indicator_start_value(m_meter1, indic, 160);
-	lv_meter_set_indicator_end_value(m_meter1, indic, 200);
+	lv_meter_set_indicator_start_value(meter1, indic, 160);
+	lv_meter_set_indicator_end_value(meter1, indic, 200);
 
-	m_meter2 = create_meter_box(cont);
+	lv_obj_set_grid_cell(m_gaugePanel, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
+}
 
-	/*Add a special circle to the needle's pivot*/
-	lv_obj_set_style_size(m_meter2, 4, LV_PART_INDICATOR);
-	lv_obj_set_style_radius(m_meter2, LV_RADIUS_CIRCLE, LV_PART_INDICATOR);
-	lv_obj_set_style_bg_opa(m_meter2, LV_OPA_COVER, LV_PART_INDICATOR);
-	lv_obj_set_style_bg_color(m_meter2, lv_palette_darken(LV_PALETTE_GREY, 4), LV_PART_INDICATOR);
-	lv_obj_set_style_text_font(m_meter2, &lv_font_montserrat_12, 0);
+void EspressoBrewTab::buildPressureGauge()
+{
+	m_pressureGauge = create_gauge(m_gaugePanel);
+	lv_obj_t* meter2 = m_pressureGauge->scaleMeter();
 
-	lv_meter_scale_t* scale2 = lv_meter_add_scale(m_meter2);
-	lv_meter_set_scale_ticks(m_meter2, scale2, 41, 1, 8, lv_palette_main(LV_PALETTE_GREY));
-	lv_meter_set_scale_major_ticks(m_meter2, scale2, 8, 2, 8, lv_color_black(), 10);
-	lv_meter_set_scale_range(m_meter2, scale2, 0, 20, 270, 135);
+	lv_meter_scale_t* scale2 = lv_meter_add_scale(meter2);
+	lv_meter_set_scale_ticks(meter2, scale2, 41, 1, 8, lv_palette_main(LV_PALETTE_GREY));
+	lv_meter_set_scale_major_ticks(meter2, scale2, 8, 2, 8, lv_color_black(), 10);
+	lv_meter_set_scale_range(meter2, scale2, 0, 20, 270, 135);
 
-	lv_meter_scale_t* scale3 = lv_meter_add_scale(m_meter2);
-	lv_meter_set_scale_ticks(m_meter2, scale3, 41, 1, 8, lv_palette_main(LV_PALETTE_GREY));
-	lv_meter_set_scale_range(m_meter2, scale3, 0, 400, 270, 135);
+	lv_meter_scale_t* scale3 = lv_meter_add_scale(meter2);
+	lv_meter_set_scale_ticks(meter2, scale3, 41, 1, 8, lv_palette_main(LV_PALETTE_GREY));
+	lv_meter_set_scale_range(meter2, scale3, 0, 400, 270, 135);
 
+	lv_meter_scale_t* pressureNeedleScale = m_pressureGauge->addNeedleScale(0, 400, 270, 135);
 	m_indic[indic_pressure] =
-		lv_meter_add_needle_line(m_meter2, scale3, 2, lv_palette_main(LV_PALETTE_BLUE), -10);
-
-	static lv_coord_t outer_grid_col_dsc[] =
-		{LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	static lv_coord_t outer_grid_row_dsc[] =
-		{LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	lv_obj_set_grid_dsc_array(cont, outer_grid_col_dsc, outer_grid_row_dsc);
-	lv_obj_set_grid_cell(m_meter1, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
-	lv_obj_set_grid_cell(m_meter2, LV_GRID_ALIGN_START, 2, 1, LV_GRID_ALIGN_START, 0, 1);
+		lv_meter_add_needle_line(m_pressureGauge->needleMeter(), pressureNeedleScale, 2, lv_palette_main(LV_PALETTE_BLUE), -10);
+
+	static constexpr lv_coord_t outer_grid_col_dsc[] =
+		{kBrew.gaugeSize, kBrew.gaugeSize, LV_GRID_TEMPLATE_LAST};
+	static constexpr lv_coord_t outer_grid_row_dsc[] =
+		{kBrew.gaugeSize, LV_GRID_TEMPLATE_LAST};
+	lv_obj_set_grid_dsc_array(m_gaugePanel, outer_grid_col_dsc, outer_grid_row_dsc);
+	lv_obj_set_grid_cell(m_tempGauge->obj(), LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
+	lv_obj_set_grid_cell(m_pressureGauge->obj(), LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 0, 1);
+}
 
+void EspressoBrewTab::buildChart()
+{
 	// Chart
-	m_chart = lv_chart_create(parent);
-	lv_obj_set_size(m_chart, 370, 170);
+	m_chart = lv_chart_create(m_parent);
+	lv_obj_set_size(m_chart, kBrew.panelWidth, kBrew.chartHeight(kLayout.pageGap));
 	lv_obj_align(m_chart, LV_ALIGN_CENTER, 0, 0);
-	lv_chart_set_range(m_chart, LV_CHART_AXIS_PRIMARY_Y, 50, 150);
-	lv_chart_set_range(m_chart, LV_CHART_AXIS_SECONDARY_Y, 0, 14*20);
-	lv_chart_set_point_count(m_chart, 325);
 
 	lv_chart_set_axis_tick(m_chart, LV_CHART_AXIS_PRIMARY_X, 3, 2, 12, 3, true, 40);
 	lv_chart_set_axis_tick(m_chart, LV_CHART_AXIS_PRIMARY_Y, 3, 2, 6, 2, true, 50);
 
-	lv_obj_set_style_text_font(m_chart, &lv_font_montserrat_8, 0);
+	lv_obj_add_style(m_chart, EspressoTheme::text(EspressoTheme::Text::Axis), 0);
 
-	m_series1 = lv_chart_add_series(m_chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
-	m_series2 = lv_chart_add_series(m_chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_SECONDARY_Y);
+	lv_obj_set_grid_cell(m_chart, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 1, 2);
+}
+
+void EspressoBrewTab::buildPlot()
+{
+	// The chart only draws the frame and axes, samples are drawn incrementally on top
+	m_plot = std::make_unique<EspressoLivePlot>(m_chart, kBrew.plotPoints);
+	m_plot->addSeries(lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y, 50, 150);
+	m_plot->addSeries(lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_SECONDARY_Y, 0, 14*20);
+}
 
+void EspressoBrewTab::buildStopwatch()
+{
 	// Panel 2 - Timer and brew/steam setting
-	lv_obj_t* panel2 = lv_obj_create(parent);
-	lv_obj_set_size(panel2, 370, 180);
-	lv_obj_set_style_pad_all(panel2, 0, LV_PART_MAIN);
+	lv_obj_t* panel2 = lv_obj_create(m_parent);
+	lv_obj_set_size(panel2, kBrew.panelWidth, kBrew.gaugeRowHeight);
+	lv_obj_add_style(panel2, EspressoTheme::flatPanel(), LV_PART_MAIN);
 
 	m_switch2 = lv_btn_create(panel2);
 	lv_obj_align(m_switch2, LV_ALIGN_CENTER, 0, 0);
@@ -325,7 +407,7 @@ EspressoBrewTab::EspressoBrewTab(lv_obj_t* parent, BoilerController* boiler, Sca
 
 	auto swLabel2 = lv_label_create(m_switch2);
 	lv_label_set_text(swLabel2, "Start");
-	lv_obj_set_style_text_font(swLabel2, &lv_font_montserrat_20, 0);
+	lv_obj_add_style(swLabel2, EspressoTheme::text(EspressoTheme::Text::Button), 0);
 	lv_obj_center(swLabel2);
 
 	m_switch3 = lv_btn_create(panel2);
@@ -335,7 +417,7 @@ EspressoBrewTab::EspressoBrewTab(lv_obj_t* parent, BoilerController* boiler, Sca
 
 	auto swLabel3 = lv_label_create(m_switch3);
 	lv_label_set_text(swLabel3, "Reset");
-	lv_obj_set_style_text_font(swLabel3, &lv_font_montserrat_20, 0);
+	lv_obj_add_style(swLabel3, EspressoTheme::text(EspressoTheme::Text::Button), 0);
 	lv_obj_center(swLabel3);
 
 	lv_obj_t* arc = lv_arc_create(panel2);
@@ -347,70 +429,76 @@ EspressoBrewTab::EspressoBrewTab(lv_obj_t* parent, BoilerController* boiler, Sca
 	lv_obj_remove_style(arc, nullptr, LV_PART_KNOB);   /*Be sure the knob is not displayed*/
 	lv_obj_clear_flag(arc, LV_OBJ_FLAG_CLICKABLE);  /*To not allow adjusting by click*/
 	lv_obj_center(arc);
-	lv_obj_set_size(arc, 160, 160);
+	lv_obj_set_size(arc, kBrew.arcSize, kBrew.arcSize);
 
 	m_arcLabel = lv_label_create(arc);
-	lv_label_set_text(m_arcLabel, "Heating");
+	m_arcText.attach(m_arcLabel);
+	m_arcText.setText("Heating");
 	lv_obj_center(m_arcLabel);
-	lv_obj_set_style_text_font(m_arcLabel, &lv_font_montserrat_28, 0);
+	lv_obj_add_style(m_arcLabel, EspressoTheme::text(EspressoTheme::Text::Stopwatch), 0);
 
-	lv_obj_align(arc, LV_ALIGN_TOP_LEFT, 30, 10);
+	lv_obj_align(arc, LV_ALIGN_TOP_LEFT, kBrew.arcX, kBrew.arcY);
 
-	auto timerData = new TimerData
-	{
-		.timerRunning = &m_timerRunning,
-		.pressure = &m_currentPressure,
-		.temperature = &m_currentTemp,
-		.time = &m_stopwatchTime,
-		.resetSwitch = m_switch3,
-		.arc = arc,
-		.chart = m_chart,
-		.chartPressureSeries = m_series2,
-		.chartTemperatureSeries = m_series1,
-		.shotLog = &m_shotLogger,
-	};
+	static_assert(sizeof(TimerData) + sizeof(ResetSwitchData) + sizeof(TimerSwitchData) <= kCallbackArenaSize);
+
+	auto* timerData = m_callbacks.make<TimerData>(
+		&m_timerRunning,
+		&m_stopwatchTime,
+		uint64_t(0),
+		m_switch3,
+		arc,
+		&m_arcText);
+	LV_ASSERT_MALLOC(timerData);
 
 	m_timer = lv_timer_create(timer_cb, kTimerPeriodMs, timerData);
 
-	auto* resetSwitchData = new ResetSwitchData
-	{
+	auto* resetSwitchData = m_callbacks.make<ResetSwitchData>(
 		m_switch2,
 		arc,
 		m_timer,
 		&m_stopwatchTime,
-	};
+		&m_arcText,
+		m_plot.get());
+	LV_ASSERT_MALLOC(resetSwitchData);
 
 	lv_obj_add_event_cb(m_switch3, reset_switch_event_cb, LV_EVENT_ALL, resetSwitchData);
 
-	auto* timerSwitchData = new TimerSwitchData
-	{
+	auto* timerSwitchData = m_callbacks.make<TimerSwitchData>(
 		&m_timerRunning,
 		m_switch3,
-		&m_shotLogger
-	};
+		&m_shotLogger);
+	LV_ASSERT_MALLOC(timerSwitchData);
 
 	lv_obj_add_event_cb(m_switch2, timer_switch_event_cb, LV_EVENT_ALL, timerSwitchData);
 
-	lv_obj_align(m_switch2, LV_ALIGN_TOP_MID, 100, 35);
-	lv_obj_align_to(m_switch3, m_switch2, LV_ALIGN_CENTER, 0, 70);
+	lv_obj_align(m_switch2, LV_ALIGN_TOP_MID, kBrew.buttonX, kBrew.buttonY);
+	lv_obj_align_to(m_switch3, m_switch2, LV_ALIGN_CENTER, 0, kBrew.buttonSpacing);
 
-	lv_obj_t* panel3 = lv_obj_create(parent);
-	lv_obj_set_size(panel3, 370, 100);
-	lv_obj_set_style_pad_all(panel3, 0, LV_PART_MAIN);
+	lv_obj_set_grid_cell(panel2, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 0, 1);
+}
+
+// Labels are bound and telemetry starts flowing once everything it updates exists
+void EspressoBrewTab::buildReadouts()
+{
+	lv_obj_t* panel3 = lv_obj_create(m_parent);
+	lv_obj_set_size(panel3, kBrew.panelWidth, kBrew.readoutHeight);
+	lv_obj_add_style(panel3, EspressoTheme::flatPanel(), LV_PART_MAIN);
 
 	m_weightLabel = lv_label_create(panel3);
-	lv_label_set_text(m_weightLabel, "---");
-	lv_obj_align(m_weightLabel, LV_ALIGN_CENTER, -80, 0);
-	lv_obj_set_style_text_font(m_weightLabel, &lv_font_montserrat_30, 0);
+	m_weightText.attach(m_weightLabel);
+	m_weightText.setText("---");
+	lv_obj_align(m_weightLabel, LV_ALIGN_CENTER, -kBrew.readoutOffset, 0);
+	lv_obj_add_style(m_weightLabel, EspressoTheme::text(EspressoTheme::Text::Readout), 0);
 
 	m_pressureLabel = lv_label_create(panel3);
-	lv_label_set_text(m_pressureLabel, "0.0 Bar");
-	lv_obj_align(m_pressureLabel, LV_ALIGN_CENTER, 80, 0);
-	lv_obj_set_style_text_font(m_pressureLabel, &lv_font_montserrat_30, 0);
+	m_pressureText.attach(m_pressureLabel);
+	m_pressureText.setText("0.0 Bar");
+	lv_obj_align(m_pressureLabel, LV_ALIGN_CENTER, kBrew.readoutOffset, 0);
+	lv_obj_add_style(m_pressureLabel, EspressoTheme::text(EspressoTheme::Text::Readout), 0);
 
-	lv_obj_t* panel4 = lv_obj_create(parent);
-	lv_obj_set_size(panel4, 370, 60);
-	lv_obj_set_style_pad_all(panel4, 0, LV_PART_MAIN);
+	lv_obj_t* panel4 = lv_obj_create(m_parent);
+	lv_obj_set_size(panel4, kBrew.panelWidth, kBrew.controlsHeight);
+	lv_obj_add_style(panel4, EspressoTheme::flatPanel(), LV_PART_MAIN);
 
 	m_hotWaterButton = lv_btn_create(panel4);
 	lv_obj_align(m_hotWaterButton, LV_ALIGN_CENTER, 0, 0);
@@ -419,27 +507,95 @@ EspressoBrewTab::EspressoBrewTab(lv_obj_t* parent, BoilerController* boiler, Sca
 
 	auto manualControlBtnLabel = lv_label_create(m_hotWaterButton);
 	lv_label_set_text(manualControlBtnLabel, "Hot Water");
-	lv_obj_set_style_text_font(manualControlBtnLabel, &lv_font_montserrat_18, 0);
+	lv_obj_add_style(manualControlBtnLabel, EspressoTheme::text(EspressoTheme::Text::Control), 0);
 	lv_obj_center(manualControlBtnLabel);
 	lv_obj_add_event_cb(m_hotWaterButton, lvgl_event_callback, LV_EVENT_ALL, (void*)this);
 
-	static lv_coord_t cont_grid_col_dsc[] =
-		{LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	static lv_coord_t cont_grid_row_dsc[] =
-		{LV_GRID_CONTENT, 180, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
+	lv_obj_set_grid_cell(panel3, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 1, 1);
+	lv_obj_set_grid_cell(panel4, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 2, 1);
 
-	lv_obj_set_grid_dsc_array(parent, cont_grid_col_dsc, cont_grid_row_dsc);
-	lv_obj_set_grid_cell(cont, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 2);
-	lv_obj_set_grid_cell(m_chart, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 2, 2);
-	lv_obj_set_grid_cell(panel2, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 0, 2);
-	lv_obj_set_grid_cell(panel3, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 2, 1);
-	lv_obj_set_grid_cell(panel4, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 3, 1);
-
-	m_scalesController->registerWeightDelegate(this);
-	m_boilerController->registerBoilerTemperatureDelegate(this);
+	m_tempNeedle.attach(m_tempGauge->needleMeter(), m_indic[indic_temp]);
+	m_tempText.attach(lv_obj_get_child(m_tempGauge->needleMeter(), -1));
+	m_pressureNeedle.attach(m_pressureGauge->needleMeter(), m_indic[indic_pressure]);
+	m_pressureGaugeText.attach(lv_obj_get_child(m_pressureGauge->needleMeter(), -1));
+
+	m_telemetryTimer = lv_timer_create(telemetry_timer_cb, kTelemetryPeriodMs, this);
+
+	TelemetryBus::get().attach(m_boilerController, m_scalesController);
+}
+
+EspressoBrewTab::~EspressoBrewTab()
+{
+	// Timers and event callbacks point into this object and its callback arena, timers only
+	// exist once their build stage has run
+	if (m_telemetryTimer != nullptr)
+		lv_timer_del(m_telemetryTimer);
+
+	if (m_timer != nullptr)
+		lv_timer_del(m_timer);
+
+	lv_obj_clean(m_parent);
+
+	lv_group_del(g);
+	g = nullptr;
+}
+
+void EspressoBrewTab::processTelemetry()
+{
+	// Only the newest reading is shown, state changes are applied in order
+	float value;
+
+	if (m_targetTempTelemetry.latest(value))
+		applyBoilerTargetTemp(value);
+
+	if (m_currentTempTelemetry.latest(value))
+		applyBoilerCurrentTemp(value);
+
+	if (m_pressureTelemetry.latest(value))
+		applyBoilerPressure(value);
+
+	if (m_weightTelemetry.latest(value))
+		applyScalesWeight(value);
+
+	m_stateTelemetry.drain([this](BoilerState state) { applyBoilerState(state); });
+
+	m_sampleTelemetry.drain([this](const TelemetrySample& sample) { applySample(sample); });
 }
 
-void EspressoBrewTab::onBoilerTargetTempChanged(float temp)
+void EspressoBrewTab::applySample(const TelemetrySample& sample)
+{
+	const uint32_t index = m_store.push(sample);
+
+	if (m_timerRunning)
+	{
+		// Measured between sample timestamps, so the stopwatch keeps real time however late the UI runs
+		if (m_hasSampleTime)
+			m_stopwatchTime += sample.timeMs - m_lastSampleTimeMs;
+
+		// A gap since the previous shot sample means the stopwatch was stopped in between
+		if (index != m_shotFirstSample + m_shotSamples)
+		{
+			m_shotFirstSample = index;
+			m_shotSamples = 0;
+		}
+
+		++m_shotSamples;
+
+		m_shotLogger.AddData(index);
+	}
+
+	m_lastSampleTimeMs = sample.timeMs;
+	m_hasSampleTime = true;
+
+	if (++m_samplesSincePlotPoint < kSamplesPerPlotPoint)
+		return;
+
+	m_samplesSincePlotPoint = 0;
+
+	m_plot->push({static_cast<lv_coord_t>(m_store.temperature(index)), static_cast<lv_coord_t>(m_store.pressure(index) * 20)});
+}
+
+void EspressoBrewTab::applyBoilerTargetTemp(float temp)
 {
 	m_targetTemp = temp;
 
@@ -452,48 +608,49 @@ void EspressoBrewTab::onBoilerTargetTempChanged(float temp)
 	auto start = round(temp - 5);
 	auto end = round(temp + 5);
 
-	lv_meter_set_indicator_start_value(m_meter1, m_indic[indic_arc], start);
-	lv_meter_set_indicator_end_value(m_meter1, m_indic[indic_arc], end);
-}
+	// The band is part of the cached scale, only re-render it when it actually moves
+	if (start == m_targetBandStart && end == m_targetBandEnd)
+		return;
 
-void EspressoBrewTab::onBoilerCurrentTempChanged(float temp)
-{
-	lv_meter_set_indicator_end_value(m_meter1, m_indic[indic_temp], static_cast<int>(temp));
+	m_targetBandStart = start;
+	m_targetBandEnd = end;
 
-	lv_obj_t* label = lv_obj_get_child(m_meter1, -1);
-	lv_label_set_text_fmt(label, "%.01f°c", temp);
+	lv_obj_t* meter1 = m_tempGauge->scaleMeter();
+	lv_meter_set_indicator_start_value(meter1, m_indic[indic_arc], start);
+	lv_meter_set_indicator_end_value(meter1, m_indic[indic_arc], end);
 
-	m_currentTemp = temp;
+	m_tempGauge->refresh();
 }
 
-void EspressoBrewTab::onBoilerPressureChanged(float pressure)
+void EspressoBrewTab::applyBoilerCurrentTemp(float temp)
 {
-	lv_meter_set_indicator_end_value(m_meter2, m_indic[indic_pressure], static_cast<int>(pressure*20));
-
-	lv_obj_t* label = lv_obj_get_child(m_meter2, -1);
-	lv_label_set_text_fmt(label, "%.01f bar", pressure);
-
-	lv_label_set_text_fmt(m_pressureLabel, "%.01f bar", pressure);
+	m_tempNeedle.setValue(static_cast<int>(temp));
+	m_tempText.setValue(temp);
+}
 
-	m_currentPressure = pressure;
+void EspressoBrewTab::applyBoilerPressure(float pressure)
+{
+	m_pressureNeedle.setValue(static_cast<int>(pressure*20));
+	m_pressureGaugeText.setValue(pressure);
+	m_pressureText.setValue(pressure);
 }
 
-void EspressoBrewTab::onBoilerStateChanged(BoilerState state)
+void EspressoBrewTab::applyBoilerState(BoilerState state)
 {
 	switch (state)
 	{
 	case BoilerState::Heating:
-		lv_label_set_text(m_arcLabel, "Heating");
+		m_arcText.setText("Heating");
 		lv_obj_add_state(m_switch2, LV_STATE_DISABLED);
 		break;
 
 	case BoilerState::Inhibited:
-		lv_label_set_text(m_arcLabel, "Inhibited");
+		m_arcText.setText("Inhibited");
 		lv_obj_add_state(m_switch2, LV_STATE_DISABLED);
 		break;
 
 	case BoilerState::Idle:
-		lv_label_set_text(m_arcLabel, "Idle");
+		m_arcText.setText("Idle");
 		lv_obj_add_state(m_switch2, LV_STATE_DISABLED);
 		break;
 
@@ -501,7 +658,7 @@ void EspressoBrewTab::onBoilerStateChanged(BoilerState state)
 
 		if (m_lastState != BoilerState::Brewing)
 		{
-			lv_label_set_text(m_arcLabel, "Ready");
+			m_arcText.setText("Ready");
 			lv_obj_clear_state(m_switch2, LV_STATE_DISABLED);
 		}
 		else
@@ -519,12 +676,68 @@ void EspressoBrewTab::onBoilerStateChanged(BoilerState state)
 	m_lastState = state;
 }
 
-void EspressoBrewTab::onScalesWeightChanged(float weight)
+void EspressoBrewTab::applyScalesWeight(float weight)
 {
 	if (weight == -999.9f)
-		lv_label_set_text(m_weightLabel, "---");
+		m_weightText.setText("---");
 	else
-		lv_label_set_text_fmt(m_weightLabel, "%0.01fg", weight);
+		m_weightText.setValue(weight);
+}
+
+void EspressoBrewTab::printSamplerStats() const
+{
+	const auto stats = m_sampler.getStats();
+
+	printf("Sampler lateness (%u ms period):\n", unsigned(m_sampler.periodMs()));
+
+	for (size_t n = 0; n < stats.lateness.size(); n++)
+	{
+		if (n < TelemetrySampler::kLatenessBucketsMs.size())
+			printf("\t< %u ms: %u\n", unsigned(TelemetrySampler::kLatenessBucketsMs[n]), unsigned(stats.lateness[n]));
+		else
+			printf("\t>= %u ms: %u\n", unsigned(TelemetrySampler::kLatenessBucketsMs.back()), unsigned(stats.lateness[n]));
+	}
+
+	printf("\tmissed: %u\n", unsigned(stats.ticksMissed));
+	printf("Fresh readings: temperature %u, pressure %u, weight %u\n", unsigned(stats.freshTemperature),
+		unsigned(stats.freshPressure), unsigned(stats.freshWeight));
+}
+
+void EspressoBrewTab::printShotSummary() const
+{
+	const uint32_t end = m_shotFirstSample + m_shotSamples;
+
+	if (m_shotSamples == 0 || ! m_store.contains(end - 1))
+	{
+		printf("No shot samples in the store\n");
+		return;
+	}
+
+	// The start of a long shot may have been overwritten
+	const uint32_t first = m_store.contains(m_shotFirstSample) ? m_shotFirstSample : m_store.first();
+	const auto summary = m_store.summarise(first, end);
+
+	printf("Shot: %u samples over %.1f s\n", unsigned(summary.samples), summary.durationMs / 1000.0f);
+	printf("\tmean temperature: %.2f °c\n", summary.meanTemperature);
+	printf("\tpeak pressure: %.2f bar\n", summary.peakPressure);
+	printf("\tpeak flow: %.2f g/s\n", summary.peakFlow);
+	printf("\tweight gain: %.1f g\n", summary.weightGain);
+}
+
+void EspressoBrewTab::printWidgetStats() const
+{
+	const WidgetBinding* bindings[] = {
+		&m_tempNeedle,
+		&m_tempText,
+		&m_pressureNeedle,
+		&m_pressureGaugeText,
+		&m_pressureText,
+		&m_weightText,
+		&m_arcText,
+	};
+
+	for (auto* binding: bindings)
+		printf("%s: %u redraws, %u skipped\n", binding->name(), unsigned(binding->invalidations()), unsigned(binding->skipped()));
 }
 
 void EspressoBrewTab::lvglEventAdapter(lv_event_t* e)
@@ -543,6 +756,6 @@ void EspressoBrewTab::hotWaterButtonEvent(lv_event_t* e)
 	const auto hotWaterEnabled = lv_obj_has_state(m_hotWaterButton, LV_STATE_CHECKED);
 
 	auto& settings = SettingsManager::get();
-	settings["HotWaterModeEnabled"] = hotWaterEnabled;
-	settings.save();
+	settings[SettingId::HotWaterModeEnabled] = hotWaterEnabled;
+	settings.requestSave();
 }
\ No newline at end of file
@@ -1,35 +1,67 @@
 #pragma once
 
+#include <memory>
+
 #include "lvgl.h"
 
 #include "BoilerController.hpp"
 #include "ScalesController.hpp"
 
+#include "CallbackArena.hpp"
+#include "EspressoGauge.hpp"
+#include "EspressoLivePlot.hpp"
+#include "EspressoViewModel.hpp"
 #include "Logging.hpp"
+#include "TelemetryBus.hpp"
+#include "TelemetrySampler.hpp"
+#include "TelemetryStore.hpp"
 
 class EspressoBrewTab
-	: public BoilerTemperatureDelegate
-	, public ScalesWeightDelegate
 {
 public:
+	// Widgets are created by buildStep(), the tab stays empty until then.
 	EspressoBrewTab(lv_obj_t* parent, BoilerController* boiler, ScalesController* scales);
-	virtual ~EspressoBrewTab() = default;
-
-	// BoilerTemperatureDelegate i/f
-	void onBoilerCurrentTempChanged(float temp) override;
-	void onBoilerTargetTempChanged(float temp) override;
-	void onBoilerStateChanged(BoilerState state) override;
-	void onBoilerPressureChanged(float pressure) override;
+	// Deletes the tab's widgets and timers, the parent must still exist.
+	virtual ~EspressoBrewTab();
 
-	// ScalesWeightDelegate i/f
-	void onScalesWeightChanged(float weight) override;
+	// Creates the next part of the tab, so it can be built a few milliseconds at a time while
+	// another screen is shown. Returns true once the tab is complete.
+	bool buildStep();
 
 	void lvglEventAdapter(lv_event_t* e);
 
+	// Applies controller updates received since the previous call, runs on the LVGL thread.
+	void processTelemetry();
+
+	// Prints how often each bound widget was redrawn versus skipped because nothing changed.
+	void printWidgetStats() const;
+
+	// Prints how late the telemetry sampler ran against its deadlines.
+	void printSamplerStats() const;
+
+	// Prints statistics of the samples recorded since the stopwatch was last started.
+	void printShotSummary() const;
+
 private:
+	void buildTemperatureGauge();
+	void buildPressureGauge();
+	void buildChart();
+	void buildPlot();
+	void buildStopwatch();
+	void buildReadouts();
+
+	void applyBoilerCurrentTemp(float temp);
+	void applyBoilerTargetTemp(float temp);
+	void applyBoilerState(BoilerState state);
+	void applyBoilerPressure(float pressure);
+	void applyScalesWeight(float weight);
+	void applySample(const TelemetrySample& sample);
+
 	void hotWaterButtonEvent(lv_event_t* e);
 
 private:
+	static constexpr size_t kCallbackArenaSize = 256;
+
 	enum
 	{
 		indic_temp,
@@ -37,13 +69,22 @@ private:
 		indic_pressure
 	};
 
+	lv_obj_t* m_parent;
+	int m_buildStage = 0;
+
+	// Contexts for the stopwatch timer and switch callbacks
+	CallbackArena<kCallbackArenaSize> m_callbacks;
+
 	bool m_timerRunning = false;
 
 	uint64_t m_stopwatchTime = 0;
 	float m_targetTemp = 0.0f;
+	int m_targetBandStart = -1;
+	int m_targetBandEnd = -1;
 
-	lv_obj_t* m_meter1;
-	lv_obj_t* m_meter2;
+	lv_obj_t* m_gaugePanel;
+	std::unique_ptr<EspressoGauge> m_tempGauge;
+	std::unique_ptr<EspressoGauge> m_pressureGauge;
 	lv_obj_t* m_switch2;
 	lv_obj_t* m_switch3;
 	lv_obj_t* m_arcLabel;
@@ -52,19 +93,41 @@ private:
 	lv_obj_t* m_hotWaterButton;
 
 	lv_obj_t* m_chart;
-	lv_chart_series_t* m_series1;
-	lv_chart_series_t* m_series2;
+	std::unique_ptr<EspressoLivePlot> m_plot;
 
 	lv_meter_indicator_t* m_indic[3];
 
-	lv_timer_t* m_timer;
+	NeedleBinding m_tempNeedle		{"Temperature needle"};
+	LabelBinding m_tempText			{"Temperature gauge", 1, "°c"};
+	NeedleBinding m_pressureNeedle	{"Pressure needle"};
+	LabelBinding m_pressureGaugeText	{"Pressure gauge", 1, " bar"};
+	LabelBinding m_pressureText		{"Pressure", 1, " bar"};
+	LabelBinding m_weightText		{"Weight", 1, "g"};
+	LabelBinding m_arcText			{"Stopwatch", 0, ""};
+
+	lv_timer_t* m_timer = nullptr;
+	lv_timer_t* m_telemetryTimer = nullptr;
+
+	TelemetryBus::FloatChannel::Subscriber m_currentTempTelemetry;
+	TelemetryBus::FloatChannel::Subscriber m_targetTempTelemetry;
+	TelemetryBus::FloatChannel::Subscriber m_pressureTelemetry;
+	TelemetryBus::StateChannel::Subscriber m_stateTelemetry;
+	TelemetryBus::FloatChannel::Subscriber m_weightTelemetry;
+
+	TelemetrySampler m_sampler;
+	TelemetrySampler::SampleChannel::Subscriber m_sampleTelemetry;
+	uint32_t m_samplesSincePlotPoint = 0;
+	uint32_t m_lastSampleTimeMs = 0;
+	bool m_hasSampleTime = false;
+
+	// Every sample, read by the plot, the shot log and the shot summary
+	TelemetryStore m_store;
+	uint32_t m_shotFirstSample = 0;
+	size_t m_shotSamples = 0;
 
 	BoilerController* m_boilerController;
 	BoilerState m_lastState = BoilerState::Heating;
 
-	float m_currentTemp = 0.0f;
-	float m_currentPressure = 0.0f;
-
 	ScalesController* m_scalesController;
 	float m_weight = 0.0f;
 
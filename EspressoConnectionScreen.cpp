@@ -1,4 +1,6 @@
 #include "EspressoConnectionScreen.hpp"
+#include "EspressoLayout.hpp"
+#include "EspressoTheme.hpp"
 
 static void anim_text_opa_cb(void* var, int32_t v)
 {
@@ -8,28 +10,23 @@ static void anim_text_opa_cb(void* var, int32_t v)
 
 EspressoConnectionScreen::EspressoConnectionScreen(const std::string& hostname)
 {
-	const lv_font_t* font_large  = &lv_font_montserrat_20;
-	const lv_font_t* font_normal = &lv_font_montserrat_18;
-
-	lv_theme_default_init(NULL,
-		lv_palette_main(LV_PALETTE_BLUE),
-		lv_palette_main(LV_PALETTE_RED),
-		LV_THEME_DEFAULT_DARK,
-		font_normal);
+	EspressoTheme::init();
 
 	init(hostname);
 }
 
 void EspressoConnectionScreen::init(const std::string& hostname)
 {
+	constexpr auto kConnection = EspressoLayout::get().connection;
+
 	lv_obj_t* spinner = lv_spinner_create(lv_scr_act(), 1250, 40);
-	lv_obj_set_size(spinner, 175, 175);
+	lv_obj_set_size(spinner, kConnection.spinnerSize, kConnection.spinnerSize);
 	lv_obj_center(spinner);
 
 	lv_obj_t* label = lv_label_create(lv_scr_act());
-	lv_obj_set_style_text_font(label, &lv_font_montserrat_24, LV_PART_MAIN);
+	lv_obj_add_style(label, EspressoTheme::text(EspressoTheme::Text::Status), LV_PART_MAIN);
 	lv_label_set_text(label, std::string("Connecting to http://" + hostname + "...").c_str());
-	lv_obj_align(label, LV_ALIGN_CENTER, 0, 150);
+	lv_obj_align(label, LV_ALIGN_CENTER, 0, kConnection.statusY);
 
 	lv_anim_t a;
 	lv_anim_init(&a);
@@ -0,0 +1,98 @@
+#include "EspressoGauge.hpp"
+
+#include <cstdio>
+
+namespace
+{
+	lv_obj_t* create_layer(lv_obj_t* parent, lv_coord_t size)
+	{
+		lv_obj_t* meter = lv_meter_create(parent);
+		lv_obj_remove_style(meter, nullptr, LV_PART_MAIN);
+		lv_obj_set_size(meter, size, size);
+		lv_obj_set_pos(meter, 0, 0);
+
+		return meter;
+	}
+
+#if ESPRESSO_UI_CACHED_GAUGES
+	// The image owns its snapshot
+	void image_delete_cb(lv_event_t* e)
+	{
+		auto* image = lv_event_get_target(e);
+		auto* snapshot = static_cast<const lv_img_dsc_t*>(lv_img_get_src(image));
+
+		if (snapshot != nullptr)
+			lv_snapshot_free(const_cast<lv_img_dsc_t*>(snapshot));
+	}
+#endif
+}
+
+EspressoGauge::EspressoGauge(lv_obj_t* parent, lv_coord_t size)
+{
+	m_container = lv_obj_create(parent);
+	lv_obj_remove_style_all(m_container);
+	lv_obj_set_size(m_container, LV_SIZE_CONTENT, LV_SIZE_CONTENT);
+	lv_obj_clear_flag(m_container, LV_OBJ_FLAG_SCROLLABLE);
+	lv_obj_add_flag(m_container, LV_OBJ_FLAG_OVERFLOW_VISIBLE);
+
+	m_scaleMeter = create_layer(m_container, size);
+
+#if ESPRESSO_UI_CACHED_GAUGES
+	// Shown in place of the scale layer once the first snapshot exists
+	m_image = lv_img_create(m_container);
+	lv_obj_add_flag(m_image, LV_OBJ_FLAG_HIDDEN);
+	lv_obj_add_flag(m_image, LV_OBJ_FLAG_FLOATING);
+	lv_obj_add_event_cb(m_image, image_delete_cb, LV_EVENT_DELETE, nullptr);
+
+	m_needleMeter = create_layer(m_container, size);
+#else
+	m_needleMeter = m_scaleMeter;
+#endif
+}
+
+lv_meter_scale_t* EspressoGauge::addNeedleScale(int32_t min, int32_t max, uint32_t angleRange, uint32_t rotation)
+{
+	lv_meter_scale_t* scale = lv_meter_add_scale(m_needleMeter);
+
+	// A new scale draws LVGL's default ticks, the needle layer must only draw needles
+	lv_meter_set_scale_ticks(m_needleMeter, scale, 0, 0, 0, lv_color_black());
+	lv_meter_set_scale_range(m_needleMeter, scale, min, max, angleRange, rotation);
+
+	return scale;
+}
+
+void EspressoGauge::refresh()
+{
+#if ESPRESSO_UI_CACHED_GAUGES
+	// The snapshot is taken at the meter's current coordinates
+	lv_obj_update_layout(m_container);
+
+	lv_obj_clear_flag(m_scaleMeter, LV_OBJ_FLAG_HIDDEN);
+	lv_img_dsc_t* snapshot = lv_snapshot_take(m_scaleMeter, LV_IMG_CF_TRUE_COLOR_ALPHA);
+
+	if (snapshot == nullptr)
+	{
+		// Out of memory, keep drawing the scale layer directly
+		printf("Gauge snapshot failed, drawing uncached\n");
+		lv_obj_add_flag(m_image, LV_OBJ_FLAG_HIDDEN);
+		return;
+	}
+
+	auto* previous = static_cast<const lv_img_dsc_t*>(lv_img_get_src(m_image));
+
+	lv_img_set_src(m_image, snapshot);
+
+	// Snapshots include the area the meter may draw outside its own coordinates
+	const lv_coord_t ext = _lv_obj_get_ext_draw_size(m_scaleMeter);
+	lv_obj_set_pos(m_image, -ext, -ext);
+
+	lv_obj_add_flag(m_scaleMeter, LV_OBJ_FLAG_HIDDEN);
+	lv_obj_clear_flag(m_image, LV_OBJ_FLAG_HIDDEN);
+
+	if (previous != nullptr)
+	{
+		lv_img_cache_invalidate_src(previous);
+		lv_snapshot_free(const_cast<lv_img_dsc_t*>(previous));
+	}
+#endif
+}
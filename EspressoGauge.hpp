@@ -0,0 +1,46 @@
+#pragma once
+
+#include "lvgl.h"
+
+// Gauges cache their scale as an image when LVGL can render objects into one
+#ifndef ESPRESSO_UI_CACHED_GAUGES
+#define ESPRESSO_UI_CACHED_GAUGES LV_USE_SNAPSHOT
+#endif
+
+// An lv_meter split into two layers. The ticks, labels and colour bands are built on scaleMeter(),
+// which is rendered once into an image. Needles go on needleMeter(), a transparent meter of the
+// same size stacked on top, so a moving needle only redraws itself over the image instead of the
+// meter recalculating every tick and label underneath it.
+//
+// Anything changed on scaleMeter() after construction shows up after the next refresh(). Without
+// snapshot support both layers are the same meter and refresh() does nothing.
+class EspressoGauge
+{
+public:
+	// Both layers are size pixels square
+	EspressoGauge(lv_obj_t* parent, lv_coord_t size);
+
+	EspressoGauge(const EspressoGauge&) = delete;
+	EspressoGauge& operator=(const EspressoGauge&) = delete;
+
+	// The object to position, e.g. with lv_obj_set_grid_cell()
+	lv_obj_t* obj() const			{ return m_container; }
+
+	lv_obj_t* scaleMeter() const	{ return m_scaleMeter; }
+	lv_obj_t* needleMeter() const	{ return m_needleMeter; }
+
+	// Adds a scale without ticks to the needle layer, matching a scale on the scale layer.
+	lv_meter_scale_t* addNeedleScale(int32_t min, int32_t max, uint32_t angleRange, uint32_t rotation);
+
+	// Renders the scale layer into the cached image again.
+	void refresh();
+
+private:
+	lv_obj_t* m_container;
+	lv_obj_t* m_scaleMeter;
+	lv_obj_t* m_needleMeter;
+
+#if ESPRESSO_UI_CACHED_GAUGES
+	lv_obj_t* m_image;
+#endif
+};
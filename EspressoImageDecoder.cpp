@@ -0,0 +1,240 @@
+#include "EspressoImageDecoder.hpp"
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+
+namespace
+{
+	constexpr uint8_t kMagic[] = { 'E', 'R', 'L', 'E' };
+	constexpr size_t kHeaderSize = sizeof(kMagic) + 1;
+	constexpr size_t kPixelSize = LV_IMG_PX_SIZE_ALPHA_BYTE;
+
+	constexpr size_t kCacheEntries = 8;
+
+	struct Entry
+	{
+		const lv_img_dsc_t* image = nullptr;
+		uint8_t* pixels = nullptr;
+		size_t size = 0;
+		uint32_t lastUse = 0;
+		uint16_t users = 0;
+	};
+
+	struct Cache
+	{
+		std::array<Entry, kCacheEntries> entries;
+		size_t bytes = 0;
+		uint32_t uses = 0;
+	};
+
+	Cache cache;
+
+	// The image if src is one of ours, compressed for this colour depth
+	const lv_img_dsc_t* compressed_image(const void* src)
+	{
+		if (lv_img_src_get_type(src) != LV_IMG_SRC_VARIABLE)
+			return nullptr;
+
+		auto* image = static_cast<const lv_img_dsc_t*>(src);
+
+		if (image->header.cf != LV_IMG_CF_RAW_ALPHA || image->data_size < kHeaderSize)
+			return nullptr;
+
+		if (memcmp(image->data, kMagic, sizeof(kMagic)) != 0 || image->data[sizeof(kMagic)] != kPixelSize)
+			return nullptr;
+
+		return image;
+	}
+
+	// False if the stream is corrupt or doesn't fill the image exactly
+	bool decode(const lv_img_dsc_t* image, uint8_t* out, size_t size)
+	{
+		const uint8_t* in = image->data + kHeaderSize;
+		const uint8_t* const inEnd = image->data + image->data_size;
+		uint8_t* const outEnd = out + size;
+
+		while (in < inEnd)
+		{
+			const uint8_t control = *in++;
+
+			if (control < 128)
+			{
+				const size_t bytes = (control + 1) * kPixelSize;
+
+				if (static_cast<size_t>(inEnd - in) < bytes || static_cast<size_t>(outEnd - out) < bytes)
+					return false;
+
+				memcpy(out, in, bytes);
+				in += bytes;
+				out += bytes;
+			}
+			else
+			{
+				const size_t count = control - 126;
+
+				if (static_cast<size_t>(inEnd - in) < kPixelSize || static_cast<size_t>(outEnd - out) < count * kPixelSize)
+					return false;
+
+				for (size_t n = 0; n < count; n++, out += kPixelSize)
+					memcpy(out, in, kPixelSize);
+
+				in += kPixelSize;
+			}
+		}
+
+		return out == outEnd;
+	}
+
+	// Frees the least recently used image nobody has open, false if there is none
+	bool evict_one()
+	{
+		Entry* oldest = nullptr;
+
+		for (auto& entry: cache.entries)
+		{
+			if (entry.image != nullptr && entry.users == 0 && (oldest == nullptr || entry.lastUse < oldest->lastUse))
+				oldest = &entry;
+		}
+
+		if (oldest == nullptr)
+			return false;
+
+		lv_mem_free(oldest->pixels);
+		cache.bytes -= oldest->size;
+		*oldest = Entry {};
+
+		return true;
+	}
+
+	Entry* free_entry()
+	{
+		for (auto& entry: cache.entries)
+		{
+			if (entry.image == nullptr)
+				return &entry;
+		}
+
+		return evict_one() ? free_entry() : nullptr;
+	}
+
+	// The cached decode of image, decoding it first on a miss
+	Entry* acquire(const lv_img_dsc_t* image)
+	{
+		for (auto& entry: cache.entries)
+		{
+			if (entry.image == image)
+				return &entry;
+		}
+
+		const size_t size = static_cast<size_t>(image->header.w) * image->header.h * kPixelSize;
+
+		while (cache.bytes + size > ESPRESSO_UI_IMAGE_CACHE_BYTES && evict_one())
+		{
+		}
+
+		Entry* entry = free_entry();
+
+		if (entry == nullptr)
+		{
+			printf("Image cache full, %u images open\n", unsigned(kCacheEntries));
+			return nullptr;
+		}
+
+		const uint32_t start = lv_tick_get();
+
+		auto* pixels = static_cast<uint8_t*>(lv_mem_alloc(size));
+
+		if (pixels == nullptr)
+		{
+			printf("Image buffer allocation failed, %u bytes\n", unsigned(size));
+			return nullptr;
+		}
+
+		if (! decode(image, pixels, size))
+		{
+			printf("Compressed image %ux%u is corrupt\n", unsigned(image->header.w), unsigned(image->header.h));
+			lv_mem_free(pixels);
+			return nullptr;
+		}
+
+		entry->image = image;
+		entry->pixels = pixels;
+		entry->size = size;
+		cache.bytes += size;
+
+		printf("Decoded %ux%u image in %u ms, image cache %u bytes\n", unsigned(image->header.w), unsigned(image->header.h),
+			unsigned(lv_tick_elaps(start)), unsigned(cache.bytes));
+
+		return entry;
+	}
+
+	lv_res_t decoder_info_cb(lv_img_decoder_t*, const void* src, lv_img_header_t* header)
+	{
+		const auto* image = compressed_image(src);
+
+		if (image == nullptr)
+			return LV_RES_INV;
+
+		header->cf = LV_IMG_CF_TRUE_COLOR_ALPHA;
+		header->always_zero = 0;
+		header->w = image->header.w;
+		header->h = image->header.h;
+
+		return LV_RES_OK;
+	}
+
+	lv_res_t decoder_open_cb(lv_img_decoder_t*, lv_img_decoder_dsc_t* dsc)
+	{
+		const auto* image = compressed_image(dsc->src);
+
+		if (image == nullptr)
+			return LV_RES_INV;
+
+		Entry* entry = acquire(image);
+
+		if (entry == nullptr)
+			return LV_RES_INV;
+
+		++entry->users;
+		entry->lastUse = ++cache.uses;
+
+		// The whole image is in memory, LVGL draws from it without asking for lines
+		dsc->img_data = entry->pixels;
+		dsc->user_data = entry;
+
+		return LV_RES_OK;
+	}
+
+	void decoder_close_cb(lv_img_decoder_t*, lv_img_decoder_dsc_t* dsc)
+	{
+		auto* entry = static_cast<Entry*>(dsc->user_data);
+
+		if (entry != nullptr)
+			--entry->users;
+
+		dsc->user_data = nullptr;
+	}
+}
+
+void EspressoImageDecoder::init()
+{
+	static bool initialised = false;
+
+	if (initialised)
+		return;
+
+	initialised = true;
+
+	lv_img_decoder_t* decoder = lv_img_decoder_create();
+	lv_img_decoder_set_info_cb(decoder, decoder_info_cb);
+	lv_img_decoder_set_open_cb(decoder, decoder_open_cb);
+	lv_img_decoder_set_close_cb(decoder, decoder_close_cb);
+}
+
+void EspressoImageDecoder::dropCache()
+{
+	while (evict_one())
+	{
+	}
+}
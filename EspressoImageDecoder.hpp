@@ -0,0 +1,30 @@
+#pragma once
+
+#include "lvgl.h"
+
+// Bytes of decoded images kept for reuse, the logo is about 23 KB at 16 bit colour
+#ifndef ESPRESSO_UI_IMAGE_CACHE_BYTES
+#define ESPRESSO_UI_IMAGE_CACHE_BYTES (48 * 1024)
+#endif
+
+// LVGL image decoder for images tools/compress_image.py stored run-length encoded. They are
+// declared and set as sources like any other lv_img_dsc_t; their colour format is
+// LV_IMG_CF_RAW_ALPHA, which LVGL's built in decoder does not handle.
+//
+// Decoded images are kept in a least recently used cache of ESPRESSO_UI_IMAGE_CACHE_BYTES, so an
+// image is only decoded again once newer ones have pushed it out. An image LVGL still has open is
+// never evicted, the cache goes over budget until it is closed.
+//
+// Stream format: "ERLE", bytes per pixel, then packets of a control byte c followed by
+//     c < 128:  c + 1 literal pixels
+//     c >= 128: one pixel repeated c - 126 times
+class EspressoImageDecoder
+{
+public:
+	// Registers the decoder on the first call, later calls do nothing. Must come before a
+	// compressed image is set as a source.
+	static void init();
+
+	// Frees every decoded image LVGL doesn't have open, each is decoded again when next drawn.
+	static void dropCache();
+};
@@ -0,0 +1,336 @@
+#pragma once
+
+#include "lvgl.h"
+
+#include <cstdint>
+
+#include "EspressoTheme.hpp"
+
+// Sizes and positions of everything on screen, one profile per EspressoTheme::DisplaySize. The
+// profile is picked from ESPRESSO_UI_DISPLAY_WIDTH at compile time and read through a constexpr
+// copy, so widgets get their geometry as constants rather than working it out from the display
+// resolution.
+//
+// Each profile is sized for every page to fit its display without scrolling, which the
+// static_asserts at the end check for all three profiles whichever one is built. Sizes assume the
+// profile's fonts in EspressoTheme.cpp, and that panels and groups don't scroll and have a border
+// of kPanelBorder, which EspressoTheme's panel styles set.
+struct EspressoLayout
+{
+	struct Header
+	{
+		lv_coord_t tabHeight;
+		lv_coord_t buttonsX;		// Tab buttons start here, the logo and title are left of it
+		bool logo;
+		lv_coord_t logoX;
+
+		// From the logo's top right corner, or from the left middle of the header without a logo
+		lv_coord_t titleX;
+		lv_coord_t titleY;
+		lv_coord_t subtitleX;
+		lv_coord_t subtitleY;
+	};
+
+	// Two columns of panels. The gauges and stopwatch fill the first row, the chart spans the
+	// readouts and controls rows beside them.
+	struct BrewTab
+	{
+		lv_coord_t panelWidth;
+		lv_coord_t gaugeRowHeight;
+		lv_coord_t readoutHeight;
+		lv_coord_t controlsHeight;
+
+		lv_coord_t gaugePad;
+		lv_coord_t gaugeGap;
+		lv_coord_t gaugeSize;
+		lv_coord_t gaugeLabelX;
+		lv_coord_t gaugeLabelY;
+
+		uint16_t plotPoints;
+
+		lv_coord_t arcSize;
+		lv_coord_t arcX;
+		lv_coord_t arcY;
+		lv_coord_t buttonX;			// From the top middle of the stopwatch panel
+		lv_coord_t buttonY;
+		lv_coord_t buttonSpacing;
+
+		lv_coord_t readoutOffset;	// Each readout's distance from the panel centre
+
+		lv_coord_t sliderWidth;
+		lv_coord_t sliderHeight;
+
+		constexpr lv_coord_t chartHeight(lv_coord_t gap) const
+		{
+			return readoutHeight + gap + controlsHeight;
+		}
+	};
+
+	// One group per row, a label and slider on each line of a group
+	struct SettingsTab
+	{
+		lv_coord_t groupWidth;
+		lv_coord_t groupPad;
+		lv_coord_t rowHeight;
+		lv_coord_t rowGap;
+		lv_coord_t columnGap;
+
+		lv_coord_t sliderWidth;
+		lv_coord_t sliderHeight;
+
+		constexpr lv_coord_t groupHeight(int rows) const
+		{
+			return 2 * (groupPad + kPanelBorder) + rows * rowHeight + (rows - 1) * rowGap;
+		}
+	};
+
+	struct ConnectionScreen
+	{
+		lv_coord_t spinnerSize;
+		lv_coord_t statusY;			// Below the centre
+	};
+
+	// Border width of the brew tab panels and settings groups, inside their size like the padding
+	static constexpr lv_coord_t kPanelBorder = 0;
+
+	// Lines in each settings group, top to bottom
+	static constexpr int kSettingsRows[] = { 2, 3, 1, 3 };
+
+	lv_coord_t width;
+	lv_coord_t height;
+
+	// Padding around a tab page and between its panels
+	lv_coord_t pagePad;
+	lv_coord_t pageGap;
+
+	Header header;
+	BrewTab brew;
+	SettingsTab settings;
+	ConnectionScreen connection;
+
+	constexpr lv_coord_t pageHeight() const
+	{
+		return height - header.tabHeight;
+	}
+
+	// 320x240
+	static constexpr EspressoLayout small()
+	{
+		EspressoLayout l {};
+
+		l.width = 320;
+		l.height = 240;
+		l.pagePad = 4;
+		l.pageGap = 4;
+
+		l.header.tabHeight = 36;
+		l.header.buttonsX = 170;
+		l.header.logo = false;
+		l.header.titleX = 6 - l.header.buttonsX;
+		l.header.titleY = -8;
+		l.header.subtitleX = 6 - l.header.buttonsX;
+		l.header.subtitleY = 8;
+
+		l.brew.panelWidth = 154;
+		l.brew.gaugeRowHeight = 100;
+		l.brew.readoutHeight = 40;
+		l.brew.controlsHeight = 48;
+		l.brew.gaugePad = 4;
+		l.brew.gaugeGap = 4;
+		l.brew.gaugeSize = 70;
+		l.brew.gaugeLabelX = 18;
+		l.brew.gaugeLabelY = 50;
+		l.brew.plotPoints = 120;
+		l.brew.arcSize = 80;
+		l.brew.arcX = 4;
+		l.brew.arcY = 10;
+		l.brew.buttonX = 40;
+		l.brew.buttonY = 10;
+		l.brew.buttonSpacing = 40;
+		l.brew.readoutOffset = 38;
+		l.brew.sliderWidth = 140;
+		l.brew.sliderHeight = 10;
+
+		l.settings.groupWidth = 312;
+		l.settings.groupPad = 4;
+		l.settings.rowHeight = 14;
+		l.settings.rowGap = 4;
+		l.settings.columnGap = 6;
+		l.settings.sliderWidth = 200;
+		l.settings.sliderHeight = 8;
+
+		l.connection.spinnerSize = 90;
+		l.connection.statusY = 75;
+
+		return l;
+	}
+
+	// 480x320
+	static constexpr EspressoLayout medium()
+	{
+		EspressoLayout l {};
+
+		l.width = 480;
+		l.height = 320;
+		l.pagePad = 6;
+		l.pageGap = 6;
+
+		l.header.tabHeight = 45;
+		l.header.buttonsX = 240;
+		l.header.logo = false;
+		l.header.titleX = 8 - l.header.buttonsX;
+		l.header.titleY = -9;
+		l.header.subtitleX = 8 - l.header.buttonsX;
+		l.header.subtitleY = 10;
+
+		l.brew.panelWidth = 231;
+		l.brew.gaugeRowHeight = 160;
+		l.brew.readoutHeight = 50;
+		l.brew.controlsHeight = 40;
+		l.brew.gaugePad = 5;
+		l.brew.gaugeGap = 6;
+		l.brew.gaugeSize = 105;
+		l.brew.gaugeLabelX = 28;
+		l.brew.gaugeLabelY = 76;
+		l.brew.plotPoints = 200;
+		l.brew.arcSize = 130;
+		l.brew.arcX = 8;
+		l.brew.arcY = 15;
+		l.brew.buttonX = 65;
+		l.brew.buttonY = 30;
+		l.brew.buttonSpacing = 60;
+		l.brew.readoutOffset = 55;
+		l.brew.sliderWidth = 200;
+		l.brew.sliderHeight = 12;
+
+		l.settings.groupWidth = 464;
+		l.settings.groupPad = 6;
+		l.settings.rowHeight = 16;
+		l.settings.rowGap = 6;
+		l.settings.columnGap = 8;
+		l.settings.sliderWidth = 330;
+		l.settings.sliderHeight = 12;
+
+		l.connection.spinnerSize = 120;
+		l.connection.statusY = 100;
+
+		return l;
+	}
+
+	// 800x480
+	static constexpr EspressoLayout large()
+	{
+		EspressoLayout l {};
+
+		l.width = 800;
+		l.height = 480;
+		l.pagePad = 15;
+		l.pageGap = 10;
+
+		l.header.tabHeight = 70;
+		l.header.buttonsX = 400;
+		l.header.logo = true;
+		l.header.logoX = 5 - l.header.buttonsX;
+		l.header.titleX = -55;
+		l.header.titleY = 10;
+		l.header.subtitleX = -35;
+		l.header.subtitleY = 32;
+
+		l.brew.panelWidth = 370;
+		l.brew.gaugeRowHeight = 180;
+		l.brew.readoutHeight = 100;
+		l.brew.controlsHeight = 60;
+		l.brew.gaugePad = 10;
+		l.brew.gaugeGap = 20;
+		l.brew.gaugeSize = 160;
+		l.brew.gaugeLabelX = 45;
+		l.brew.gaugeLabelY = 115;
+		l.brew.plotPoints = 325;
+		l.brew.arcSize = 160;
+		l.brew.arcX = 30;
+		l.brew.arcY = 10;
+		l.brew.buttonX = 100;
+		l.brew.buttonY = 35;
+		l.brew.buttonSpacing = 70;
+		l.brew.readoutOffset = 80;
+		l.brew.sliderWidth = 330;
+		l.brew.sliderHeight = 15;
+
+		l.settings.groupWidth = 760;
+		l.settings.groupPad = 12;
+		l.settings.rowHeight = 20;
+		l.settings.rowGap = 10;
+		l.settings.columnGap = 10;
+		l.settings.sliderWidth = 580;
+		l.settings.sliderHeight = 20;
+
+		l.connection.spinnerSize = 175;
+		l.connection.statusY = 150;
+
+		return l;
+	}
+
+	static constexpr EspressoLayout forSize(EspressoTheme::DisplaySize size)
+	{
+		switch (size)
+		{
+		case EspressoTheme::DisplaySize::Small:
+			return small();
+
+		case EspressoTheme::DisplaySize::Medium:
+			return medium();
+
+		default:
+			return large();
+		}
+	}
+
+	// The profile the UI is built for
+	static constexpr EspressoLayout get()
+	{
+		return forSize(EspressoTheme::displaySize());
+	}
+
+	constexpr bool brewTabFits() const
+	{
+		const bool columns = 2 * pagePad + 2 * brew.panelWidth + pageGap <= width;
+		const bool rows = 2 * pagePad + brew.gaugeRowHeight + pageGap + brew.chartHeight(pageGap) <= pageHeight();
+
+		const lv_coord_t inset = 2 * (brew.gaugePad + kPanelBorder);
+		const bool gauges = inset + 2 * brew.gaugeSize + brew.gaugeGap <= brew.panelWidth
+			&& inset + brew.gaugeSize <= brew.gaugeRowHeight;
+
+		const bool stopwatch = brew.arcX + brew.arcSize <= brew.panelWidth - 2 * kPanelBorder
+			&& brew.arcY + brew.arcSize <= brew.gaugeRowHeight - 2 * kPanelBorder;
+
+		return columns && rows && gauges && stopwatch;
+	}
+
+	constexpr bool settingsTabFits() const
+	{
+		lv_coord_t groups = 0;
+
+		for (int lines: kSettingsRows)
+			groups += settings.groupHeight(lines) + pageGap;
+
+		const bool rows = 2 * pagePad + groups - pageGap <= pageHeight();
+		const bool columns = 2 * pagePad + settings.groupWidth <= width
+			&& 2 * (settings.groupPad + kPanelBorder) + settings.columnGap + settings.sliderWidth < settings.groupWidth;
+
+		return rows && columns && settings.sliderHeight <= settings.rowHeight;
+	}
+
+	constexpr bool connectionScreenFits() const
+	{
+		return connection.spinnerSize / 2 < connection.statusY && connection.statusY + 20 <= height / 2;
+	}
+
+	constexpr bool fits() const
+	{
+		return brewTabFits() && settingsTabFits() && connectionScreenFits();
+	}
+};
+
+static_assert(EspressoLayout::small().fits(), "Small layout profile doesn't fit 320x240");
+static_assert(EspressoLayout::medium().fits(), "Medium layout profile doesn't fit 480x320");
+static_assert(EspressoLayout::large().fits(), "Large layout profile doesn't fit 800x480");
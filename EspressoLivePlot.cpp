@@ -0,0 +1,191 @@
+#include "EspressoLivePlot.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+	// The canvas owns its buffer
+	void canvas_delete_cb(lv_event_t* e)
+	{
+		lv_mem_free(lv_event_get_user_data(e));
+	}
+}
+
+EspressoLivePlot::EspressoLivePlot(lv_obj_t* chart, uint16_t pointCount)
+	: m_chart(chart)
+	, m_pointCount(pointCount)
+{
+	lv_chart_set_point_count(m_chart, m_pointCount);
+
+	// Size of the plot area, the chart's content box
+	lv_obj_update_layout(m_chart);
+	m_width = lv_obj_get_content_width(m_chart);
+	m_height = lv_obj_get_content_height(m_chart);
+
+	if (m_width < 2 || m_height < 2)
+		return;
+
+	const uint32_t bufferSize = LV_CANVAS_BUF_SIZE_TRUE_COLOR(m_width, m_height);
+	m_buffer = static_cast<lv_color_t*>(lv_mem_alloc(bufferSize));
+
+	if (m_buffer == nullptr)
+	{
+		printf("Live plot buffer allocation failed, using chart series\n");
+		return;
+	}
+
+	printf("Live plot canvas %d x %d, %u bytes\n", m_width, m_height, static_cast<unsigned>(bufferSize));
+
+	m_maxColumns = std::min<lv_coord_t>(m_width, History::kCapacity);
+	m_lineWidth = std::max<lv_coord_t>(1, lv_obj_get_style_line_width(m_chart, LV_PART_ITEMS));
+
+	// The chart's own division lines are hidden by the canvas
+	lv_chart_set_div_line_count(m_chart, 0, 0);
+
+	const lv_color_t background = lv_obj_get_style_bg_color(m_chart, LV_PART_MAIN);
+	m_divisionColor = lv_obj_get_style_line_color(m_chart, LV_PART_MAIN);
+
+	m_gridColumn.assign(m_height, background);
+
+	for (int n = 0; n < kHorizontalDivisions; n++)
+		m_gridColumn[(m_height - 1) * n / (kHorizontalDivisions - 1)] = m_divisionColor;
+
+	for (int n = 0; n < kVerticalDivisions; n++)
+		m_divisionColumns[n] = (m_width - 1) * n / (kVerticalDivisions - 1);
+
+	m_canvas = lv_canvas_create(m_chart);
+	lv_canvas_set_buffer(m_canvas, m_buffer, m_width, m_height, LV_IMG_CF_TRUE_COLOR);
+	lv_obj_set_pos(m_canvas, 0, 0);
+	lv_obj_add_event_cb(m_canvas, canvas_delete_cb, LV_EVENT_DELETE, m_buffer);
+
+	redraw();
+}
+
+void EspressoLivePlot::addSeries(lv_color_t color, lv_chart_axis_t axis, lv_coord_t min, lv_coord_t max)
+{
+	if (m_seriesCount == kMaxSeries)
+		return;
+
+	auto& series = m_series[m_seriesCount++];
+	series.color = color;
+	series.min = min;
+	series.max = max;
+
+	lv_chart_set_range(m_chart, axis, min, max);
+
+	if (m_canvas == nullptr)
+		series.chartSeries = lv_chart_add_series(m_chart, color, axis);
+}
+
+void EspressoLivePlot::push(std::initializer_list<lv_coord_t> values)
+{
+	const size_t count = std::min(values.size(), m_seriesCount);
+
+	if (m_canvas == nullptr)
+	{
+		for (size_t n = 0; n < count; n++)
+			lv_chart_set_next_value(m_chart, m_series[n].chartSeries, values.begin()[n]);
+
+		return;
+	}
+
+	History::Sample sample {};
+	std::copy_n(values.begin(), count, sample.begin());
+
+	// Nothing to draw until the level on screen completes a bucket
+	if (m_history.push(sample) <= m_level)
+		return;
+
+	if (m_columns < m_maxColumns)
+	{
+		const lv_coord_t x = m_columns++;
+
+		drawColumn(x, m_history.size(m_level) - 1);
+		invalidateColumns(x - m_lineWidth + 1, x);
+		return;
+	}
+
+	if (m_level + 1 < History::kLevels)
+		++m_level;
+
+	redraw();
+}
+
+void EspressoLivePlot::clear()
+{
+	m_history.clear();
+	m_level = 0;
+
+	if (m_canvas != nullptr)
+		redraw();
+}
+
+lv_coord_t EspressoLivePlot::toY(const Series& series, lv_coord_t value) const
+{
+	const int32_t range = std::max<int32_t>(1, series.max - series.min);
+	const int32_t clamped = std::clamp<int32_t>(value, series.min, series.max);
+
+	return static_cast<lv_coord_t>((m_height - 1) - (clamped - series.min) * (m_height - 1) / range);
+}
+
+void EspressoLivePlot::redraw()
+{
+	for (lv_coord_t y = 0; y < m_height; y++)
+	{
+		lv_color_t* row = m_buffer + y * m_width;
+
+		std::fill_n(row, m_width, m_gridColumn[y]);
+
+		for (auto x: m_divisionColumns)
+			row[x] = m_divisionColor;
+	}
+
+	// The newest buckets that fit
+	const size_t available = m_history.size(m_level);
+	m_columns = static_cast<lv_coord_t>(std::min<size_t>(available, m_maxColumns));
+
+	const size_t first = available - m_columns;
+
+	for (lv_coord_t x = 0; x < m_columns; x++)
+		drawColumn(x, first + x);
+
+	lv_obj_invalidate(m_canvas);
+}
+
+void EspressoLivePlot::drawColumn(lv_coord_t x, size_t bucket)
+{
+	const auto& current = m_history.at(m_level, bucket);
+	const auto& previous = bucket > 0 ? m_history.at(m_level, bucket - 1) : current;
+
+	for (size_t n = 0; n < m_seriesCount; n++)
+	{
+		const auto& series = m_series[n];
+
+		// Reaching over to the previous column's range keeps the trace joined up
+		const lv_coord_t low = std::min(current.min[n], previous.max[n]);
+		const lv_coord_t high = std::max(current.max[n], previous.min[n]);
+
+		const lv_coord_t top = toY(series, high);
+		const lv_coord_t bottom = toY(series, low);
+
+		for (lv_coord_t y = top; y <= bottom; y++)
+		{
+			lv_color_t* row = m_buffer + y * m_width;
+
+			for (lv_coord_t column = std::max<lv_coord_t>(0, x - m_lineWidth + 1); column <= x; column++)
+				row[column] = series.color;
+		}
+	}
+}
+
+void EspressoLivePlot::invalidateColumns(lv_coord_t x1, lv_coord_t x2)
+{
+	lv_area_t area;
+	lv_obj_get_coords(m_canvas, &area);
+
+	area.x2 = area.x1 + x2;
+	area.x1 = area.x1 + std::max<lv_coord_t>(0, x1);
+
+	lv_obj_invalidate_area(m_canvas, &area);
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "lvgl.h"
+
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <vector>
+
+#include "MinMaxHistory.hpp"
+
+// Line plot drawn on a canvas laid over an lv_chart's plot area. The chart still draws the frame
+// and axis labels, which never change.
+//
+// Samples go into a MinMaxHistory and the plot shows the finest level whose buckets fit across
+// its width, one pixel column per bucket drawn as a min/max span. A new bucket only draws its own
+// column. When the plot is full it switches to the next coarser level and redraws once, so a
+// whole shot or warm-up stays on screen and the cost of a frame does not grow with its length.
+// Once the coarsest level is full the newest buckets are shown.
+//
+// Division lines come from a cached background which is copied into a column before it is drawn.
+//
+// The canvas buffer takes LV_CANVAS_BUF_SIZE_TRUE_COLOR(width, height) of LVGL's heap for as long
+// as the brew tab exists, the chart's content box at the colour depth. At 16 bit colour the brew
+// tab's chart of each layout profile bounds it at 28 KB for Small (154 x 92), 43 KB for Medium
+// (231 x 96) and 123 KB for Large (370 x 170), less the chart's padding.
+//
+// If the canvas buffer cannot be allocated the plot falls back to ordinary chart series holding
+// the last pointCount samples.
+class EspressoLivePlot
+{
+public:
+	static constexpr size_t kMaxSeries = 2;
+
+	// At the 100 ms sample period the coarsest level spans about 35 minutes
+	using History = MinMaxHistory<lv_coord_t, kMaxSeries, 7, 512>;
+
+	EspressoLivePlot(lv_obj_t* chart, uint16_t pointCount);
+
+	EspressoLivePlot(const EspressoLivePlot&) = delete;
+	EspressoLivePlot& operator=(const EspressoLivePlot&) = delete;
+
+	// Series are pushed in the order they were added. min and max set the value range mapped
+	// onto the chart height, as lv_chart_set_range() does for axis.
+	void addSeries(lv_color_t color, lv_chart_axis_t axis, lv_coord_t min, lv_coord_t max);
+
+	// Appends one value per series.
+	void push(std::initializer_list<lv_coord_t> values);
+
+	// Forgets the history and starts again at full detail, e.g. when a shot starts.
+	void clear();
+
+private:
+	struct Series
+	{
+		lv_color_t color;
+		lv_coord_t min;
+		lv_coord_t max;
+
+		lv_chart_series_t* chartSeries = nullptr;
+	};
+
+	static constexpr int kHorizontalDivisions = 3;
+	static constexpr int kVerticalDivisions = 5;
+
+	lv_coord_t toY(const Series& series, lv_coord_t value) const;
+
+	void redraw();
+	void drawColumn(lv_coord_t x, size_t bucket);
+	void invalidateColumns(lv_coord_t x1, lv_coord_t x2);
+
+	lv_obj_t* m_chart;
+	lv_obj_t* m_canvas = nullptr;
+	lv_color_t* m_buffer = nullptr;
+
+	uint16_t m_pointCount;
+	lv_coord_t m_width = 0;
+	lv_coord_t m_height = 0;
+	lv_coord_t m_lineWidth = 1;
+
+	// Cached background, one colour per row plus the columns holding vertical division lines
+	lv_color_t m_divisionColor;
+	std::vector<lv_color_t> m_gridColumn;
+	std::array<lv_coord_t, kVerticalDivisions> m_divisionColumns;
+
+	size_t m_seriesCount = 0;
+	std::array<Series, kMaxSeries> m_series;
+
+	History m_history;
+
+	// Level shown and how many of its buckets are drawn, one per column from the left
+	size_t m_level = 0;
+	lv_coord_t m_columns = 0;
+	lv_coord_t m_maxColumns = 0;
+};
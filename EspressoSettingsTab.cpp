@@ -1,10 +1,36 @@
 #include "EspressoSettingsTab.hpp"
+#include "EspressoLayout.hpp"
+#include "EspressoTheme.hpp"
+
+#include <iterator>
+
+namespace
+{
+	constexpr auto kSettings = EspressoLayout::get().settings;
+
+	// Label column and slider column, one fixed height line per slider
+	constexpr lv_coord_t kGroupColumns[] = {LV_GRID_CONTENT, kSettings.sliderWidth, LV_GRID_TEMPLATE_LAST};
+	constexpr lv_coord_t kGroupRows[] = {kSettings.rowHeight, kSettings.rowHeight, kSettings.rowHeight, LV_GRID_TEMPLATE_LAST};
+
+	// Grid rows for a group of up to three sliders, the tail of kGroupRows
+	constexpr const lv_coord_t* group_rows(int lines)
+	{
+		return kGroupRows + std::size(kGroupRows) - 1 - lines;
+	}
+
+	struct SliderData
+	{
+		lv_obj_t* label;
+		SettingId id;
+		const char* fmt;	// String literal
+	};
+}
 
 static lv_obj_t* createLabel(lv_obj_t* parent, const char* text)
 {
 	auto label = lv_label_create(parent);
 	lv_label_set_text(label, text);
-	lv_obj_set_style_text_font(label, &lv_font_montserrat_16, LV_PART_MAIN);
+	lv_obj_add_style(label, EspressoTheme::text(EspressoTheme::Text::Body), LV_PART_MAIN);
 
 	return label;
 }
@@ -12,30 +38,35 @@ static lv_obj_t* createLabel(lv_obj_t* parent, const char* text)
 static void sliderCb(lv_event_t* e)
 {
 	lv_obj_t* slider = lv_event_get_target(e);
-	auto [label, key, fmt] = *static_cast<std::tuple<lv_obj_t*, std::string, std::string>*>(lv_event_get_user_data(e));
+	auto [label, id, fmt] = *static_cast<SliderData*>(lv_event_get_user_data(e));
 	auto val = lv_slider_get_value(slider);
 
-	lv_label_set_text_fmt(label, fmt.c_str(), val);
+	lv_label_set_text_fmt(label, fmt, val);
 
 	auto& settings = SettingsManager::get();
-	settings[key] = static_cast<float>(val);
-	settings.save();
+	settings[id] = static_cast<float>(val);
+	settings.requestSave();
 }
 
-static std::pair<lv_obj_t*, lv_obj_t*> createSlider(lv_obj_t* parent, const std::string& key, const std::pair<int, int>& range, const std::string& fmt)
+std::pair<lv_obj_t*, lv_obj_t*> EspressoSettingsTab::createSlider(lv_obj_t* parent, SettingId id, const char* fmt)
 {
+	const auto& schema = schemaFor(id);
+
 	auto slider = lv_slider_create(parent);
-	auto initial = SettingsManager::get()[key].getAs<float>();
+	auto initial = SettingsManager::get()[id].getAs<float>();
 
-	lv_slider_set_range(slider, range.first, range.second);
+	lv_slider_set_range(slider, static_cast<int>(schema.min), static_cast<int>(schema.max));
 	lv_slider_set_value(slider, static_cast<int>(initial), LV_ANIM_OFF);
-	lv_obj_set_size(slider, 580, 20);
+	lv_obj_set_size(slider, kSettings.sliderWidth, kSettings.sliderHeight);
 
 	auto label = lv_label_create(parent);
-	lv_obj_set_style_text_font(label, &lv_font_montserrat_16, LV_PART_MAIN);
-	lv_label_set_text_fmt(label, fmt.c_str(), static_cast<int>(initial));
+	lv_obj_add_style(label, EspressoTheme::text(EspressoTheme::Text::Body), LV_PART_MAIN);
+	lv_label_set_text_fmt(label, fmt, static_cast<int>(initial));
+
+	auto* data = m_callbacks.make<SliderData>(label, id, fmt);
+	LV_ASSERT_MALLOC(data);
 
-	lv_obj_add_event_cb(slider, sliderCb, LV_EVENT_VALUE_CHANGED, new std::tuple<lv_obj_t*, std::string, std::string>(label, key, fmt));
+	lv_obj_add_event_cb(slider, sliderCb, LV_EVENT_VALUE_CHANGED, data);
 
 	return { slider, label };
 }
@@ -45,21 +76,36 @@ EspressoSettingsTab::EspressoSettingsTab(lv_obj_t* parent)
 {
 	lv_obj_set_flex_flow(m_parent, LV_FLEX_FLOW_ROW);
 
-	static lv_coord_t parent_grid_col_dsc[] = {LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	static lv_coord_t parent_grid_row_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
+	lv_obj_add_style(m_parent, EspressoTheme::tabPage(), 0);
+
+	constexpr auto& rows = EspressoLayout::kSettingsRows;
+
+	static constexpr lv_coord_t parent_grid_col_dsc[] = {kSettings.groupWidth, LV_GRID_TEMPLATE_LAST};
+	static constexpr lv_coord_t parent_grid_row_dsc[] = {
+		kSettings.groupHeight(rows[0]),
+		kSettings.groupHeight(rows[1]),
+		kSettings.groupHeight(rows[2]),
+		kSettings.groupHeight(rows[3]),
+		LV_GRID_TEMPLATE_LAST};
 	lv_obj_set_grid_dsc_array(parent, parent_grid_col_dsc, parent_grid_row_dsc);
 
 	lv_obj_t* boilerSettingsContainer = lv_obj_create(parent);
-	lv_obj_set_size(boilerSettingsContainer, 760, 110);
+	lv_obj_set_size(boilerSettingsContainer, kSettings.groupWidth, kSettings.groupHeight(rows[0]));
 
 	lv_obj_t* boilerPIDContainer = lv_obj_create(parent);
-	lv_obj_set_size(boilerPIDContainer, 760, 130);
+	lv_obj_set_size(boilerPIDContainer, kSettings.groupWidth, kSettings.groupHeight(rows[1]));
 
 	lv_obj_t* pumpSettingsContainer = lv_obj_create(parent);
-	lv_obj_set_size(pumpSettingsContainer, 760, 65);
+	lv_obj_set_size(pumpSettingsContainer, kSettings.groupWidth, kSettings.groupHeight(rows[2]));
 
 	lv_obj_t* pumpPIDContainer = lv_obj_create(parent);
-	lv_obj_set_size(pumpPIDContainer, 760, 130);
+	lv_obj_set_size(pumpPIDContainer, kSettings.groupWidth, kSettings.groupHeight(rows[3]));
+
+	for (auto* group: {boilerSettingsContainer, boilerPIDContainer, pumpSettingsContainer, pumpPIDContainer})
+	{
+		lv_obj_add_style(group, EspressoTheme::settingsGroup(), 0);
+		lv_obj_clear_flag(group, LV_OBJ_FLAG_SCROLLABLE);
+	}
 
 	lv_obj_set_grid_cell(boilerSettingsContainer,  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(boilerPIDContainer, LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 1, 1);
@@ -69,71 +115,67 @@ EspressoSettingsTab::EspressoSettingsTab(lv_obj_t* parent)
 	auto& settings = SettingsManager::get();
 
 	// Temperature Settings Container
-	auto [slider1, sliderlabel] = createSlider(boilerSettingsContainer, "BrewTemp", {85, 100}, "%d°c");
-	auto [slider2, sliderlabel2] = createSlider(boilerSettingsContainer, "SteamTemp", {120, 150}, "%d°c");
+	auto [slider1, sliderlabel] = createSlider(boilerSettingsContainer, SettingId::BrewTemp, "%d°c");
+	auto [slider2, sliderlabel2] = createSlider(boilerSettingsContainer, SettingId::SteamTemp, "%d°c");
 
-	static lv_coord_t grid_col_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	static lv_coord_t grid_row_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	lv_obj_set_grid_dsc_array(boilerSettingsContainer, grid_col_dsc, grid_row_dsc);
+	lv_obj_set_grid_dsc_array(boilerSettingsContainer, kGroupColumns, group_rows(rows[0]));
 
 	lv_obj_set_grid_cell(createLabel(boilerSettingsContainer, "Brew Temp."),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(slider1, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(sliderlabel, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 0, 1);
 
-	lv_obj_set_grid_cell(createLabel(boilerSettingsContainer, "Steam Temp."),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 2, 1);
-	lv_obj_set_grid_cell(slider2, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 2, 1);
-	lv_obj_set_grid_cell(sliderlabel2, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 2, 1);
+	lv_obj_set_grid_cell(createLabel(boilerSettingsContainer, "Steam Temp."),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 1, 1);
+	lv_obj_set_grid_cell(slider2, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 1, 1);
+	lv_obj_set_grid_cell(sliderlabel2, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 1, 1);
 
 
 	// BoilerPID Container
-	static lv_coord_t boilerPID_grid_col_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	static lv_coord_t boilerPID_grid_row_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
+	lv_obj_set_grid_dsc_array(boilerPIDContainer, kGroupColumns, group_rows(rows[1]));
 
-	lv_obj_set_grid_dsc_array(boilerPIDContainer, boilerPID_grid_col_dsc, boilerPID_grid_row_dsc);
-
-	auto [slider4, sliderlabel4] = createSlider(boilerPIDContainer, "BoilerKp", {1, 500}, "%d");
+	auto [slider4, sliderlabel4] = createSlider(boilerPIDContainer, SettingId::BoilerKp, "%d");
 	lv_obj_set_grid_cell(createLabel(boilerPIDContainer, "Kp Term"),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(slider4, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(sliderlabel4, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 0, 1);
 
-	auto [slider5, sliderlabel5] = createSlider(boilerPIDContainer, "BoilerKi", {1, 500}, "%d");
+	auto [slider5, sliderlabel5] = createSlider(boilerPIDContainer, SettingId::BoilerKi, "%d");
 	lv_obj_set_grid_cell(createLabel(boilerPIDContainer, "Ki Term"),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 1, 1);
 	lv_obj_set_grid_cell(slider5, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 1, 1);
 	lv_obj_set_grid_cell(sliderlabel5, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 1, 1);
 
-	auto [slider6, sliderlabel6] = createSlider(boilerPIDContainer, "BoilerKd", {1, 500}, "%d");
+	auto [slider6, sliderlabel6] = createSlider(boilerPIDContainer, SettingId::BoilerKd, "%d");
 	lv_obj_set_grid_cell(createLabel(boilerPIDContainer, "Kd Term"),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 2, 1);
 	lv_obj_set_grid_cell(slider6, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 2, 1);
 	lv_obj_set_grid_cell(sliderlabel6, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 2, 1);
 
 	// Pressure Settings Container
-	static lv_coord_t grid2_col_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	static lv_coord_t grid2_row_dsc[] = {LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	lv_obj_set_grid_dsc_array(pumpSettingsContainer, grid2_col_dsc, grid2_row_dsc);
+	lv_obj_set_grid_dsc_array(pumpSettingsContainer, kGroupColumns, group_rows(rows[2]));
 
-	auto [slider3, sliderlabel3] = createSlider(pumpSettingsContainer, "BrewPressure", {6, 12}, "%d bar");
+	auto [slider3, sliderlabel3] = createSlider(pumpSettingsContainer, SettingId::BrewPressure, "%d bar");
 	lv_obj_set_grid_cell(createLabel(pumpSettingsContainer, "Brew Pressure"),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(slider3, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(sliderlabel3, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 0, 1);
 
 	// PumpPID Container
-	static lv_coord_t pumpPID_grid_col_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-	static lv_coord_t pumpPID_grid_row_dsc[] = {LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_CONTENT, LV_GRID_TEMPLATE_LAST};
-
-	lv_obj_set_grid_dsc_array(pumpPIDContainer, pumpPID_grid_col_dsc, pumpPID_grid_row_dsc);
+	lv_obj_set_grid_dsc_array(pumpPIDContainer, kGroupColumns, group_rows(rows[3]));
 
-	auto [pumpKpSlider, pumpKpLabel] = createSlider(pumpPIDContainer, "PumpKp", {1, 500}, "%d");
+	auto [pumpKpSlider, pumpKpLabel] = createSlider(pumpPIDContainer, SettingId::PumpKp, "%d");
 	lv_obj_set_grid_cell(createLabel(pumpPIDContainer, "Kp Term"),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(pumpKpSlider, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 0, 1);
 	lv_obj_set_grid_cell(pumpKpLabel, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 0, 1);
 
-	auto [pumpKiSlider, pumpKiLabel] = createSlider(pumpPIDContainer, "PumpKi", {1, 500}, "%d");
+	auto [pumpKiSlider, pumpKiLabel] = createSlider(pumpPIDContainer, SettingId::PumpKi, "%d");
 	lv_obj_set_grid_cell(createLabel(pumpPIDContainer, "Ki Term"),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 1, 1);
 	lv_obj_set_grid_cell(pumpKiSlider, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 1, 1);
 	lv_obj_set_grid_cell(pumpKiLabel, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 1, 1);
 
-	auto [pumpKdSlider, pumpKdLabel] = createSlider(pumpPIDContainer, "PumpKd", {1, 500}, "%d");
+	auto [pumpKdSlider, pumpKdLabel] = createSlider(pumpPIDContainer, SettingId::PumpKd, "%d");
 	lv_obj_set_grid_cell(createLabel(pumpPIDContainer, "Kd Term"),  LV_GRID_ALIGN_START, 0, 1, LV_GRID_ALIGN_START, 2, 1);
 	lv_obj_set_grid_cell(pumpKdSlider, LV_GRID_ALIGN_START, 1, 1, LV_GRID_ALIGN_START, 2, 1);
 	lv_obj_set_grid_cell(pumpKdLabel, LV_GRID_ALIGN_CENTER, 1, 1, LV_GRID_ALIGN_CENTER, 2, 1);
 }
+
+EspressoSettingsTab::~EspressoSettingsTab()
+{
+	// Slider callbacks point into the callback arena
+	lv_obj_clean(m_parent);
+}
@@ -1,15 +1,26 @@
 #pragma once
 
+#include <utility>
+
 #include "lvgl.h"
 
+#include "CallbackArena.hpp"
 #include "Settings/SettingsManager.hpp"
 
 class EspressoSettingsTab
 {
 public:
 	EspressoSettingsTab(lv_obj_t* parent);
-	~EspressoSettingsTab() = default;
+	// Deletes the tab's widgets, the parent must still exist.
+	~EspressoSettingsTab();
 
 private:
+	static constexpr size_t kCallbackArenaSize = 256;
+
+	std::pair<lv_obj_t*, lv_obj_t*> createSlider(lv_obj_t* parent, SettingId id, const char* fmt);
+
 	lv_obj_t*	m_parent;
+
+	// One context per slider
+	CallbackArena<kCallbackArenaSize> m_callbacks;
 };
@@ -0,0 +1,182 @@
+#include "EspressoTheme.hpp"
+#include "EspressoLayout.hpp"
+
+#include <array>
+
+// With ESPRESSO_UI_SUBSET_FONTS on, CMake puts the fonts tools/subset_fonts.py generated from the
+// UI's strings on the include path and they replace LVGL's built in Montserrat
+#if __has_include("EspressoSubsetFonts.h")
+#include "EspressoSubsetFonts.h"
+#define ESPRESSO_FONT(size) (&espresso_font_montserrat_##size)
+#else
+#define ESPRESSO_FONT(size) (&lv_font_montserrat_##size)
+#endif
+
+namespace
+{
+	struct Styles
+	{
+		std::array<lv_style_t, static_cast<size_t>(EspressoTheme::Text::Count)> text;
+		lv_style_t flatPanel;
+		lv_style_t gaugePanel;
+		lv_style_t tabPage;
+		lv_style_t header;
+		lv_style_t settingsGroup;
+		lv_style_t needlePivot;
+	};
+
+	Styles styles;
+
+	void init_text(EspressoTheme::Text role, const lv_font_t* font)
+	{
+		auto* style = EspressoTheme::text(role);
+
+		lv_style_init(style);
+		lv_style_set_text_font(style, font);
+	}
+
+	void init_styles()
+	{
+		using Text = EspressoTheme::Text;
+
+		// The layout profiles in EspressoLayout.hpp are sized for these
+#if ESPRESSO_UI_DISPLAY_SMALL
+		init_text(Text::Axis, ESPRESSO_FONT(8));
+		init_text(Text::Scale, ESPRESSO_FONT(8));
+		init_text(Text::Body, ESPRESSO_FONT(12));
+		init_text(Text::Control, ESPRESSO_FONT(12));
+		init_text(Text::Button, ESPRESSO_FONT(12));
+		init_text(Text::Status, ESPRESSO_FONT(14));
+		init_text(Text::Stopwatch, ESPRESSO_FONT(16));
+		init_text(Text::Readout, ESPRESSO_FONT(16));
+#elif ESPRESSO_UI_DISPLAY_MEDIUM
+		init_text(Text::Axis, ESPRESSO_FONT(8));
+		init_text(Text::Scale, ESPRESSO_FONT(10));
+		init_text(Text::Body, ESPRESSO_FONT(14));
+		init_text(Text::Control, ESPRESSO_FONT(14));
+		init_text(Text::Button, ESPRESSO_FONT(16));
+		init_text(Text::Status, ESPRESSO_FONT(18));
+		init_text(Text::Stopwatch, ESPRESSO_FONT(22));
+		init_text(Text::Readout, ESPRESSO_FONT(22));
+#else
+		init_text(Text::Axis, ESPRESSO_FONT(8));
+		init_text(Text::Scale, ESPRESSO_FONT(12));
+		init_text(Text::Body, ESPRESSO_FONT(16));
+		init_text(Text::Control, ESPRESSO_FONT(18));
+		init_text(Text::Button, ESPRESSO_FONT(20));
+		init_text(Text::Status, ESPRESSO_FONT(24));
+		init_text(Text::Stopwatch, ESPRESSO_FONT(28));
+		init_text(Text::Readout, ESPRESSO_FONT(30));
+#endif
+		init_text(Text::Title, EspressoTheme::fontLarge());
+		init_text(Text::Subtitle, EspressoTheme::fontNormal());
+		lv_style_set_text_opa(EspressoTheme::text(Text::Subtitle), LV_OPA_70);
+
+		constexpr auto layout = EspressoLayout::get();
+
+		lv_style_init(&styles.flatPanel);
+		lv_style_set_pad_all(&styles.flatPanel, 0);
+		lv_style_set_border_width(&styles.flatPanel, EspressoLayout::kPanelBorder);
+
+		lv_style_init(&styles.gaugePanel);
+		lv_style_set_pad_all(&styles.gaugePanel, layout.brew.gaugePad);
+		lv_style_set_pad_row(&styles.gaugePanel, 0);
+		lv_style_set_pad_column(&styles.gaugePanel, layout.brew.gaugeGap);
+		lv_style_set_border_width(&styles.gaugePanel, EspressoLayout::kPanelBorder);
+
+		lv_style_init(&styles.tabPage);
+		lv_style_set_pad_all(&styles.tabPage, layout.pagePad);
+		lv_style_set_pad_row(&styles.tabPage, layout.pageGap);
+		lv_style_set_pad_column(&styles.tabPage, layout.pageGap);
+
+		lv_style_init(&styles.header);
+		lv_style_set_pad_left(&styles.header, layout.header.buttonsX);
+
+		lv_style_init(&styles.settingsGroup);
+		lv_style_set_pad_all(&styles.settingsGroup, layout.settings.groupPad);
+		lv_style_set_pad_row(&styles.settingsGroup, layout.settings.rowGap);
+		lv_style_set_pad_column(&styles.settingsGroup, layout.settings.columnGap);
+		lv_style_set_border_width(&styles.settingsGroup, EspressoLayout::kPanelBorder);
+
+		lv_style_init(&styles.needlePivot);
+		lv_style_set_size(&styles.needlePivot, 4);
+		lv_style_set_radius(&styles.needlePivot, LV_RADIUS_CIRCLE);
+		lv_style_set_bg_opa(&styles.needlePivot, LV_OPA_COVER);
+		lv_style_set_bg_color(&styles.needlePivot, lv_palette_darken(LV_PALETTE_GREY, 4));
+	}
+}
+
+const lv_font_t* EspressoTheme::fontLarge()
+{
+#if ESPRESSO_UI_DISPLAY_SMALL
+	return ESPRESSO_FONT(14);
+#elif ESPRESSO_UI_DISPLAY_MEDIUM
+	return ESPRESSO_FONT(16);
+#else
+	return ESPRESSO_FONT(20);
+#endif
+}
+
+const lv_font_t* EspressoTheme::fontNormal()
+{
+#if ESPRESSO_UI_DISPLAY_SMALL
+	return ESPRESSO_FONT(12);
+#elif ESPRESSO_UI_DISPLAY_MEDIUM
+	return ESPRESSO_FONT(14);
+#else
+	return ESPRESSO_FONT(18);
+#endif
+}
+
+void EspressoTheme::init()
+{
+	static bool initialised = false;
+
+	if (initialised)
+		return;
+
+	initialised = true;
+
+	lv_theme_default_init(NULL,
+		lv_palette_main(LV_PALETTE_BLUE),
+		lv_palette_main(LV_PALETTE_RED),
+		LV_THEME_DEFAULT_DARK,
+		fontNormal());
+
+	init_styles();
+}
+
+lv_style_t* EspressoTheme::text(Text role)
+{
+	return &styles.text[static_cast<size_t>(role)];
+}
+
+lv_style_t* EspressoTheme::flatPanel()
+{
+	return &styles.flatPanel;
+}
+
+lv_style_t* EspressoTheme::gaugePanel()
+{
+	return &styles.gaugePanel;
+}
+
+lv_style_t* EspressoTheme::tabPage()
+{
+	return &styles.tabPage;
+}
+
+lv_style_t* EspressoTheme::header()
+{
+	return &styles.header;
+}
+
+lv_style_t* EspressoTheme::settingsGroup()
+{
+	return &styles.settingsGroup;
+}
+
+lv_style_t* EspressoTheme::needlePivot()
+{
+	return &styles.needlePivot;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "lvgl.h"
+
+// Width of the display the UI is built for. Fonts and the layout profile are chosen from it at
+// compile time, LVGL only knows the resolution once the display driver is registered. The
+// profile's Montserrat sizes, see EspressoTheme.cpp, must be enabled in lv_conf.h.
+#ifndef ESPRESSO_UI_DISPLAY_WIDTH
+#define ESPRESSO_UI_DISPLAY_WIDTH 800
+#endif
+
+#define ESPRESSO_UI_DISPLAY_SMALL (ESPRESSO_UI_DISPLAY_WIDTH <= 320)
+#define ESPRESSO_UI_DISPLAY_MEDIUM (! ESPRESSO_UI_DISPLAY_SMALL && ESPRESSO_UI_DISPLAY_WIDTH < 720)
+
+// Fonts, the LVGL theme and the styles shared by every screen, chosen from the display width.
+//
+// Widgets attach the shared styles with lv_obj_add_style() rather than setting local style
+// properties, so there is one copy of each style however many widgets use it and objects don't
+// carry a local style list of their own. Local properties are left for values that change at
+// run time, such as an animated opacity.
+class EspressoTheme
+{
+public:
+	enum class DisplaySize
+	{
+		Small,
+		Medium,
+		Large,
+	};
+
+	// Text styles by what the text is, each sets one font
+	enum class Text
+	{
+		Axis,			// Chart axis labels
+		Scale,			// Gauge tick labels
+		Body,			// Gauge values and settings labels
+		Control,		// Secondary buttons
+		Button,			// Primary buttons
+		Status,			// Connection screen
+		Stopwatch,
+		Readout,		// Weight and pressure
+		Title,			// Header and tab names
+		Subtitle,		// Header, dimmed
+		Count
+	};
+
+	static constexpr DisplaySize displaySize()
+	{
+		if (ESPRESSO_UI_DISPLAY_SMALL)
+			return DisplaySize::Small;
+
+		if (ESPRESSO_UI_DISPLAY_MEDIUM)
+			return DisplaySize::Medium;
+
+		return DisplaySize::Large;
+	}
+
+	static const lv_font_t* fontLarge();
+	static const lv_font_t* fontNormal();
+
+	// Initialises the default theme and the shared styles on the first call. Later calls do
+	// nothing, initialising the theme again would restyle every object that already exists.
+	static void init();
+
+	static lv_style_t* text(Text role);
+
+	// Panel without padding, for children placed with lv_obj_align()
+	static lv_style_t* flatPanel();
+
+	// Panel holding the two gauges side by side
+	static lv_style_t* gaugePanel();
+
+	// Tab page, rows of panels
+	static lv_style_t* tabPage();
+
+	// Header buttons, pushed right to leave room for the logo and title. Apply to the tab
+	// buttons object.
+	static lv_style_t* header();
+
+	// Settings tab group, a column of labels and a column of sliders
+	static lv_style_t* settingsGroup();
+
+	// The circle over a needle's pivot, apply to LV_PART_INDICATOR
+	static lv_style_t* needlePivot();
+};
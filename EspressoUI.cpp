@@ -1,71 +1,253 @@
 #include "EspressoUI.hpp"
+#include "EspressoImageDecoder.hpp"
+#include "EspressoLayout.hpp"
+#include "EspressoTheme.hpp"
+
+#include <algorithm>
+#include <cstdio>
+
+namespace
+{
+	// Settings observers are notified at most once per period, however fast a slider is dragged
+	constexpr uint32_t kSettingsDispatchPeriodMs = 33;
+
+	// Settings prebuild once there was no input for kPrebuildIdleMs
+	constexpr uint32_t kPrebuildIdleMs = 1000;
+	constexpr uint32_t kPrebuildPollMs = 250;
+
+	constexpr uint16_t kSettingsTabIndex = 1;
+
+	// Build steps run from a timer for at most a slice each frame, which leaves the rest of the
+	// frame to the screen shown meanwhile
+	constexpr uint32_t kBuildPeriodMs = 30;
+	constexpr uint32_t kBuildSliceMs = 8;
+
+	void settings_dispatch_cb(lv_timer_t*)
+	{
+		SettingsManager::get().dispatchChanges();
+	}
+
+	uint32_t count_objects(lv_obj_t* obj)
+	{
+		uint32_t count = 1;
+
+		for (uint32_t n = 0; n < lv_obj_get_child_cnt(obj); n++)
+			count += count_objects(lv_obj_get_child(obj, n));
+
+		return count;
+	}
+
+	void tab_changed_cb(lv_event_t* e)
+	{
+		if (lv_tabview_get_tab_act(lv_event_get_target(e)) != kSettingsTabIndex)
+			return;
+
+		static_cast<EspressoUI*>(lv_event_get_user_data(e))->buildSettingsTab();
+	}
+
+#if ESPRESSO_UI_PREBUILD_SETTINGS
+	void prebuild_timer_cb(lv_timer_t* t)
+	{
+		if (lv_disp_get_inactive_time(nullptr) < kPrebuildIdleMs)
+			return;
+
+		static_cast<EspressoUI*>(t->user_data)->buildSettingsTab();
+	}
+#endif
+
+	void build_timer_cb(lv_timer_t* t)
+	{
+		static_cast<EspressoUI*>(t->user_data)->buildSlice();
+	}
+
+	void first_frame_cb(lv_event_t* e)
+	{
+		static_cast<EspressoUI*>(lv_event_get_user_data(e))->reportFirstFrame();
+	}
+}
+
+EspressoUI::~EspressoUI()
+{
+	if (m_buildTimer != nullptr)
+		lv_timer_del(m_buildTimer);
+
+	if (m_prebuildTimer != nullptr)
+		lv_timer_del(m_prebuildTimer);
+
+	if (m_dispatchTimer != nullptr)
+		lv_timer_del(m_dispatchTimer);
+}
+
+void EspressoUI::prebuild(BoilerController* boiler, ScalesController* scales)
+{
+	if (m_buildTimer != nullptr || m_built)
+		return;
+
+	m_boiler = boiler;
+	m_scales = scales;
+
+	m_buildStartTick = lv_tick_get();
+	m_buildTimer = lv_timer_create(build_timer_cb, kBuildPeriodMs, this);
+}
+
+void EspressoUI::show()
+{
+	while (! buildSlice())
+	{
+	}
+
+	if (lv_scr_act() == m_screen)
+		return;
+
+	m_showTick = lv_tick_get();
+	lv_obj_add_event_cb(m_screen, first_frame_cb, LV_EVENT_DRAW_POST_END, this);
+
+	lv_scr_load_anim(m_screen, LV_SCR_LOAD_ANIM_NONE, 0, 0, true);
+
+#if ESPRESSO_UI_PREBUILD_SETTINGS
+	// Idle time only counts once the user can see the UI
+	m_prebuildTimer = lv_timer_create(prebuild_timer_cb, kPrebuildPollMs, this);
+#endif
+
+	m_dispatchTimer = lv_timer_create(settings_dispatch_cb, kSettingsDispatchPeriodMs, nullptr);
+}
 
 void EspressoUI::init(BoilerController* boiler, ScalesController* scales)
 {
-	DisplaySize disp_size = DisplaySize::Large;
+	prebuild(boiler, scales);
+	show();
+}
 
-	if (LV_HOR_RES <= 320)
-		disp_size = DisplaySize::Small;
-	else if (LV_HOR_RES < 720)
-		disp_size = DisplaySize::Medium;
+bool EspressoUI::buildSlice()
+{
+	if (m_built)
+		return true;
 
-	lv_coord_t tab_h;
-	const lv_font_t* font_large = LV_FONT_DEFAULT;
-	const lv_font_t* font_normal = LV_FONT_DEFAULT;
+	const uint32_t start = lv_tick_get();
 
-	switch (disp_size)
+	do
 	{
-		case DisplaySize::Large:
-			tab_h = 70;
-			font_large = &lv_font_montserrat_20;
-			font_normal = &lv_font_montserrat_18;
-			break;
-
-		case DisplaySize::Medium:
-			tab_h = 45;
-			font_large = &lv_font_montserrat_16;
-			font_normal = &lv_font_montserrat_14;
-			break;
-
-		case DisplaySize::Small:
-			tab_h = 45;
-			font_large = &lv_font_montserrat_16;
-			font_normal = &lv_font_montserrat_14;
-			break;
+		// A slice only ends between steps, so the longest step is how far a frame can overrun
+		const uint32_t stepStart = lv_tick_get();
+		m_built = buildStep();
+		m_longestBuildStep = std::max(m_longestBuildStep, lv_tick_elaps(stepStart));
 	}
+	while (! m_built && lv_tick_elaps(start) < kBuildSliceMs);
 
-	lv_theme_default_init(NULL,
-		lv_palette_main(LV_PALETTE_BLUE),
-		lv_palette_main(LV_PALETTE_RED),
-		LV_THEME_DEFAULT_DARK,
-		font_normal);
+	++m_buildSlices;
 
-	auto* tv = lv_tabview_create(lv_scr_act(), LV_DIR_TOP, tab_h);
+	if (! m_built)
+		return false;
 
-	lv_obj_t* tab_btns = lv_tabview_get_tab_btns(tv);
-	lv_obj_set_style_pad_left(tab_btns, LV_HOR_RES / 2, 0);
+	if (m_buildTimer != nullptr)
+	{
+		lv_timer_del(m_buildTimer);
+		m_buildTimer = nullptr;
+	}
+
+	printf("Main UI built in %u ms over %u slices, longest step %u ms\n", unsigned(lv_tick_elaps(m_buildStartTick)),
+		unsigned(m_buildSlices), unsigned(m_longestBuildStep));
+
+	return true;
+}
+
+bool EspressoUI::buildStep()
+{
+	if (m_screen == nullptr)
+	{
+		buildFrame();
+		return false;
+	}
+
+	if (! m_brewTab)
+	{
+		m_brewTab = std::make_unique<EspressoBrewTab>(m_brewPage, m_boiler, m_scales);
+		return false;
+	}
+
+	return m_brewTab->buildStep();
+}
+
+// The screen, tab view and header. Tab contents are built by later steps.
+void EspressoUI::buildFrame()
+{
+	// The layout profile and fonts are picked at compile time for this width
+	LV_ASSERT(lv_disp_get_hor_res(nullptr) == ESPRESSO_UI_DISPLAY_WIDTH);
 
-	lv_obj_t* logo = lv_img_create(tab_btns);
-	LV_IMG_DECLARE(espresso_logo);
-	lv_img_set_src(logo, &espresso_logo);
-	lv_obj_align(logo, LV_ALIGN_LEFT_MID, -LV_HOR_RES / 2 + 5, 2);
+	EspressoTheme::init();
+	EspressoImageDecoder::init();
+
+	constexpr auto kHeader = EspressoLayout::get().header;
+
+	m_screen = lv_obj_create(nullptr);
+
+	auto* tv = lv_tabview_create(m_screen, LV_DIR_TOP, kHeader.tabHeight);
+	lv_obj_t* tab_btns = lv_tabview_get_tab_btns(tv);
+	lv_obj_add_style(tab_btns, EspressoTheme::header(), 0);
 
 	lv_obj_t* label1 = lv_label_create(tab_btns);
 	lv_label_set_text(label1, "ESPresso v0.01");
-	lv_obj_align_to(label1, logo, LV_ALIGN_OUT_RIGHT_TOP, -55, 10);
-	lv_obj_set_style_text_font(label1, font_large, 0);
+	lv_obj_add_style(label1, EspressoTheme::text(EspressoTheme::Text::Title), 0);
 
 	lv_obj_t* label2 = lv_label_create(tab_btns);
 	lv_label_set_text(label2, "Gaggia Classic Pro");
-	lv_obj_set_style_text_font(label2, font_normal, 0);
-	lv_obj_set_style_text_opa(label2, LV_OPA_70, 0);
-	lv_obj_align_to(label2, logo, LV_ALIGN_OUT_RIGHT_TOP, -35, 32);
+	lv_obj_add_style(label2, EspressoTheme::text(EspressoTheme::Text::Subtitle), 0);
+
+	// Smaller headers are too short for the logo
+	if (kHeader.logo)
+	{
+		lv_obj_t* logo = lv_img_create(tab_btns);
+		LV_IMG_DECLARE(espresso_logo);
+		lv_img_set_src(logo, &espresso_logo);
+		lv_obj_align(logo, LV_ALIGN_LEFT_MID, kHeader.logoX, 2);
+
+		lv_obj_align_to(label1, logo, LV_ALIGN_OUT_RIGHT_TOP, kHeader.titleX, kHeader.titleY);
+		lv_obj_align_to(label2, logo, LV_ALIGN_OUT_RIGHT_TOP, kHeader.subtitleX, kHeader.subtitleY);
+	}
+	else
+	{
+		lv_obj_align(label1, LV_ALIGN_LEFT_MID, kHeader.titleX, kHeader.titleY);
+		lv_obj_align(label2, LV_ALIGN_LEFT_MID, kHeader.subtitleX, kHeader.subtitleY);
+	}
+
+	m_brewPage = lv_tabview_add_tab(tv, "Brew");
+	m_settingsPage = lv_tabview_add_tab(tv, "Settings");
+
+	lv_obj_add_style(tv, EspressoTheme::text(EspressoTheme::Text::Title), 0);
+
+	lv_obj_add_event_cb(tv, tab_changed_cb, LV_EVENT_VALUE_CHANGED, this);
+}
+
+void EspressoUI::buildSettingsTab()
+{
+	if (m_settingsTab)
+		return;
+
+	if (m_prebuildTimer != nullptr)
+	{
+		lv_timer_del(m_prebuildTimer);
+		m_prebuildTimer = nullptr;
+	}
+
+	const uint32_t start = lv_tick_get();
+
+	m_settingsTab = std::make_unique<EspressoSettingsTab>(m_settingsPage);
+
+	const uint32_t objects = count_objects(m_screen);
+	m_peakObjects = std::max(m_peakObjects, objects);
+
+	printf("Settings tab built in %u ms, %u objects (peak %u)\n", unsigned(lv_tick_elaps(start)), unsigned(objects), unsigned(m_peakObjects));
+}
+
+void EspressoUI::reportFirstFrame()
+{
+	if (m_firstFrameReported)
+		return;
 
-	lv_obj_t* t1 = lv_tabview_add_tab(tv, "Brew");
-	lv_obj_t* t2 = lv_tabview_add_tab(tv, "Settings");
+	m_firstFrameReported = true;
 
-	lv_obj_set_style_text_font(tv, font_large, 0);
+	const uint32_t objects = count_objects(m_screen);
+	m_peakObjects = std::max(m_peakObjects, objects);
 
-	m_brewTab = std::make_unique<EspressoBrewTab>(t1, boiler, scales);
-	m_settingsTab = std::make_unique<EspressoSettingsTab>(t2);
+	printf("First frame %u ms after show, %u objects\n", unsigned(lv_tick_elaps(m_showTick)), unsigned(objects));
 }
@@ -9,22 +9,63 @@
 #include "EspressoBrewTab.hpp"
 #include "EspressoSettingsTab.hpp"
 
+// The settings tab is built the first time it is selected. With prebuilding it is also built once
+// the user has left the screen alone for a moment, so the first switch to it doesn't stall.
+#ifndef ESPRESSO_UI_PREBUILD_SETTINGS
+#define ESPRESSO_UI_PREBUILD_SETTINGS 1
+#endif
+
+// The main UI lives on a screen of its own. prebuild() creates it a slice per frame while the
+// screen shown before, e.g. EspressoConnectionScreen, keeps animating, and show() swaps it in
+// with a single screen load.
 class EspressoUI
 {
 public:
 	EspressoUI() = default;
-	~EspressoUI() = default;
+	~EspressoUI();
+
+	// Starts building the UI in the background.
+	void prebuild(BoilerController* boiler, ScalesController* scales);
+
+	// Call after prebuild(). Builds whatever it hasn't got to yet, then loads the UI's screen
+	// and deletes the one shown before.
+	void show();
 
+	// prebuild() and show() at once.
 	void init(BoilerController* boiler, ScalesController* scales);
 
+	// Runs build steps for up to one slice, returns true once the UI is complete.
+	bool buildSlice();
+
+	// Does nothing once the tab exists.
+	void buildSettingsTab();
+
+	// Prints the time from show() to the first frame and the object count, once.
+	void reportFirstFrame();
+
 private:
-	enum class DisplaySize
-	{
-		Small,
-		Medium,
-		Large,
-	};
+	bool buildStep();
+	void buildFrame();
+
+	BoilerController* m_boiler = nullptr;
+	ScalesController* m_scales = nullptr;
+
+	lv_obj_t* m_screen = nullptr;
+	lv_obj_t* m_brewPage = nullptr;
+	lv_obj_t* m_settingsPage = nullptr;
 
 	std::unique_ptr<EspressoBrewTab>		m_brewTab;
 	std::unique_ptr<EspressoSettingsTab>	m_settingsTab;
+
+	lv_timer_t* m_buildTimer = nullptr;
+	lv_timer_t* m_prebuildTimer = nullptr;
+	lv_timer_t* m_dispatchTimer = nullptr;
+	bool m_built = false;
+
+	uint32_t m_buildStartTick = 0;
+	uint32_t m_buildSlices = 0;
+	uint32_t m_longestBuildStep = 0;
+	uint32_t m_showTick = 0;
+	uint32_t m_peakObjects = 0;
+	bool m_firstFrameReported = false;
 };
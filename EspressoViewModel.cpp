@@ -0,0 +1,74 @@
+#include "EspressoViewModel.hpp"
+
+#include <cstring>
+
+LabelBinding::LabelBinding(const char* name, int decimals, const char* suffix)
+	: WidgetBinding(name)
+	, m_decimals(decimals)
+	, m_suffix(suffix)
+{
+}
+
+void LabelBinding::attach(lv_obj_t* label)
+{
+	m_label = label;
+	m_showingValue = false;
+	m_shownText = nullptr;
+}
+
+void LabelBinding::setValue(float value)
+{
+	const auto rounded = toFixedPoint(value, m_decimals);
+
+	if (m_showingValue && rounded == m_shownValue)
+	{
+		++m_skipped;
+		return;
+	}
+
+	formatFixedPoint(m_text, sizeof(m_text), rounded, m_decimals, m_suffix);
+
+	// Also tells LVGL the buffer contents changed
+	lv_label_set_text_static(m_label, m_text);
+	++m_invalidations;
+
+	m_showingValue = true;
+	m_shownValue = rounded;
+}
+
+void LabelBinding::setText(const char* text)
+{
+	if (! m_showingValue && m_shownText != nullptr && std::strcmp(m_shownText, text) == 0)
+	{
+		++m_skipped;
+		return;
+	}
+
+	lv_label_set_text_static(m_label, text);
+	++m_invalidations;
+
+	m_showingValue = false;
+	m_shownText = text;
+}
+
+void NeedleBinding::attach(lv_obj_t* meter, lv_meter_indicator_t* indicator)
+{
+	m_meter = meter;
+	m_indicator = indicator;
+	m_valid = false;
+}
+
+void NeedleBinding::setValue(int32_t value)
+{
+	if (m_valid && value == m_shownValue)
+	{
+		++m_skipped;
+		return;
+	}
+
+	lv_meter_set_indicator_end_value(m_meter, m_indicator, value);
+	++m_invalidations;
+
+	m_valid = true;
+	m_shownValue = value;
+}
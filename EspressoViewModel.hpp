@@ -0,0 +1,77 @@
+#pragma once
+
+#include "lvgl.h"
+
+#include "FixedPointFormat.hpp"
+
+#include <cstdint>
+
+// Sits between the telemetry handlers and the widgets. Each binding remembers what its widget
+// currently shows and only calls into LVGL, which invalidates and redraws the widget, when the
+// visible text or needle position would actually change.
+//
+// Labels point at text owned by the binding (lv_label_set_text_static), so updating a reading
+// neither allocates nor runs LVGL's printf.
+
+class WidgetBinding
+{
+public:
+	explicit WidgetBinding(const char* name)
+		: m_name(name)
+	{
+	}
+
+	const char* name() const		{ return m_name; }
+	uint32_t invalidations() const	{ return m_invalidations; }
+	uint32_t skipped() const		{ return m_skipped; }
+
+protected:
+	const char* m_name;
+	uint32_t m_invalidations = 0;
+	uint32_t m_skipped = 0;
+};
+
+class LabelBinding : public WidgetBinding
+{
+public:
+	// Values are shown with the given number of decimals followed by suffix, which must outlive the binding.
+	LabelBinding(const char* name, int decimals, const char* suffix);
+
+	void attach(lv_obj_t* label);
+
+	void setValue(float value);
+
+	// text is not copied and must outlive the binding, string literals in practice.
+	void setText(const char* text);
+
+private:
+	static constexpr size_t kTextCapacity = 32;
+
+	lv_obj_t* m_label = nullptr;
+	int m_decimals;
+	const char* m_suffix;
+
+	// What the label shows, either a rounded number or a fixed text
+	bool m_showingValue = false;
+	FixedPoint m_shownValue;
+	const char* m_shownText = nullptr;
+
+	char m_text[kTextCapacity] = {};
+};
+
+class NeedleBinding : public WidgetBinding
+{
+public:
+	using WidgetBinding::WidgetBinding;
+
+	void attach(lv_obj_t* meter, lv_meter_indicator_t* indicator);
+
+	void setValue(int32_t value);
+
+private:
+	lv_obj_t* m_meter = nullptr;
+	lv_meter_indicator_t* m_indicator = nullptr;
+
+	bool m_valid = false;
+	int32_t m_shownValue = 0;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Formats sensor readings with a fixed number of decimals without going through printf. The
+// output is the same as snprintf("%.<decimals>f"): value * 10^decimals is exact in a double for
+// up to three decimals, and rint() rounds ties to even exactly like printf does on that value.
+
+constexpr int kMaxFixedPointDecimals = 3;
+
+// A value rounded to the displayed resolution, e.g. 93.46 at one decimal is { 935, false }.
+// negative is kept separately so -0.04 can be shown as "-0.0" like printf does.
+struct FixedPoint
+{
+	int64_t scaled = 0;
+	bool negative = false;
+	bool valid = false;
+
+	bool operator==(const FixedPoint& other) const
+	{
+		return scaled == other.scaled && negative == other.negative && valid == other.valid;
+	}
+
+	bool operator!=(const FixedPoint& other) const
+	{
+		return ! (*this == other);
+	}
+};
+
+namespace FixedPointDetail
+{
+	constexpr double kPow10[kMaxFixedPointDecimals + 1] = { 1.0, 10.0, 100.0, 1000.0 };
+
+	// Keeps the scaled value well inside int64_t, far beyond any reading the machine produces
+	constexpr double kMaxScaled = 1e15;
+}
+
+// NaN, infinities and values too large to represent come back with valid == false.
+inline FixedPoint toFixedPoint(float value, int decimals)
+{
+	FixedPoint result;
+
+	const double scaled = std::rint(static_cast<double>(value) * FixedPointDetail::kPow10[decimals]);
+
+	if (! std::isfinite(scaled) || std::fabs(scaled) >= FixedPointDetail::kMaxScaled)
+		return result;
+
+	result.negative = std::signbit(value);
+	result.scaled = static_cast<int64_t>(std::fabs(scaled));
+	result.valid = true;
+
+	return result;
+}
+
+// Writes the value followed by suffix into out, always NUL terminated and truncated to size.
+// Invalid values are written as "---". Returns the length written.
+inline size_t formatFixedPoint(char* out, size_t size, const FixedPoint& value, int decimals, const char* suffix = "")
+{
+	if (size == 0)
+		return 0;
+
+	char digits[24];
+	size_t length = 0;
+
+	if (! value.valid)
+	{
+		digits[length++] = '-';
+		digits[length++] = '-';
+		digits[length++] = '-';
+	}
+	else
+	{
+		// Digits are produced least significant first, then reversed into out
+		auto remaining = value.scaled;
+
+		for (int n = 0; n < decimals; n++)
+		{
+			digits[length++] = static_cast<char>('0' + remaining % 10);
+			remaining /= 10;
+		}
+
+		if (decimals > 0)
+			digits[length++] = '.';
+
+		do
+		{
+			digits[length++] = static_cast<char>('0' + remaining % 10);
+			remaining /= 10;
+		}
+		while (remaining != 0);
+
+		if (value.negative)
+			digits[length++] = '-';
+
+		for (size_t n = 0; n < length / 2; n++)
+		{
+			const auto c = digits[n];
+			digits[n] = digits[length - 1 - n];
+			digits[length - 1 - n] = c;
+		}
+	}
+
+	size_t pos = 0;
+
+	for (size_t n = 0; n < length && pos + 1 < size; n++)
+		out[pos++] = digits[n];
+
+	for (; *suffix != '\0' && pos + 1 < size; suffix++)
+		out[pos++] = *suffix;
+
+	out[pos] = '\0';
+
+	return pos;
+}
+
+inline size_t formatFixedPoint(char* out, size_t size, float value, int decimals, const char* suffix = "")
+{
+	return formatFixedPoint(out, size, toFixedPoint(value, decimals), decimals, suffix);
+}
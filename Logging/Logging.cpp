@@ -1,13 +1,34 @@
 #include "Logging.hpp"
 
+#include <algorithm>
 #include <chrono>
 #include <sstream>
 #include <filesystem>
 
 namespace fs = std::filesystem;
 
-Logging::Logging(bool autoFlush, const std::string& fileSuffix)
+namespace
+{
+	// The store quantises to the log's fixed point units, records are logged as they are
+	static_assert(ShotLogFormat::kChannelDecimals[ShotLogFormat::Temperature] == TelemetryStore::kTemperatureDecimals);
+	static_assert(ShotLogFormat::kChannelDecimals[ShotLogFormat::Pressure] == TelemetryStore::kPressureDecimals);
+	static_assert(ShotLogFormat::kChannelDecimals[ShotLogFormat::Weight] == TelemetryStore::kWeightDecimals);
+	static_assert(ShotLogFormat::kChannelDecimals[ShotLogFormat::Flow] == TelemetryStore::kFlowDecimals);
+	static_assert(ShotLogFormat::kChannelDecimals[ShotLogFormat::State] == 0);
+
+	ShotLogFormat::Sample to_log_sample(const TelemetryStore::Record& record)
+	{
+		return { record.temperature, record.pressure, record.weight, record.flow, record.state };
+	}
+}
+
+Logging::Logging(const TelemetryStore& store, bool autoFlush, const std::string& fileSuffix, WriteMode mode, FileFormat format, uint16_t samplePeriodMs)
 	: m_autoFlush(autoFlush)
+	, m_samplePeriodMs(samplePeriodMs)
+	, m_writeMode(mode)
+	, m_fileFormat(format)
+	, m_store(store)
+	, m_encoder(samplePeriodMs)
 {
 	auto now = std::chrono::system_clock::now();
 	auto in_time_t = std::chrono::system_clock::to_time_t(now);
@@ -18,35 +39,282 @@ Logging::Logging(bool autoFlush, const std::string& fileSuffix)
 	m_fileName = ssFileName.str();
 
 	fs::create_directory("logs");
+
+	for (auto& block: m_blocks)
+		m_freeBlocks.push(&block);
+
+	if (m_writeMode == WriteMode::Background)
+		m_writerThread = std::thread(&Logging::writerTask, this);
+}
+
+Logging::~Logging()
+{
+	if (! m_writerThread.joinable())
+		return;
+
+	{
+		std::lock_guard lock(m_queueMutex);
+		m_stopWriter = true;
+	}
+
+	m_queueCondition.notify_one();
+	m_writerThread.join();
+}
+
+void Logging::AddData(uint32_t index)
+{
+	auto* segment = m_segments.empty() ? nullptr : &m_segments.back();
+
+	// A sample that doesn't follow the open segment starts a new one, so a shot can begin while
+	// the previous one is still queued for the writer
+	if (segment != nullptr && ! segment->endOfLog && index == segment->start + segment->count)
+	{
+		++segment->count;
+	}
+	else
+	{
+		// Only full with kMaxPendingSegments runs waiting on a stalled writer, the UI doesn't wait
+		if (m_segments.full())
+			FlushLog(false);
+
+		if (! m_segments.push({ index, 1, false }))
+		{
+			++m_samplesDropped;
+			return;
+		}
+	}
+
+	++m_queued;
+
+	if (m_autoFlush || m_queued >= kFlushThreshold)
+		FlushLog(false);
 }
 
 void Logging::FlushLog(bool newFile)
+{
+	dropOverwritten();
+
+	if (newFile)
+	{
+		// Samples queued after this point belong to the next log. A log that already ended
+		// stays ended, without samples since there is nothing to write. With nothing queued the
+		// end goes to the writer on its own, to close a file it has open.
+		if (m_segments.empty())
+			m_segments.push({ 0, 0, true });
+		else
+			m_segments.back().endOfLog = true;
+	}
+
+	while (! m_segments.empty())
+	{
+		auto& segment = m_segments[0];
+		Segment done;
+
+		if (segment.count == 0 && ! segment.endOfLog)
+		{
+			// Every sample was overwritten before it could be handed over
+			m_segments.pop(done);
+			continue;
+		}
+
+		auto* block = acquireBlock();
+
+		if (block == nullptr)
+		{
+			// Writer is behind, leave the samples queued in the store until the next flush
+			m_samplesDelayed += m_queued - m_delayedInBuffer;
+			m_delayedInBuffer = m_queued;
+			return;
+		}
+
+		const auto limit = std::min(segment.count, kBlockCapacity);
+
+		for (block->count = 0; block->count < limit; ++block->count)
+			block->samples[block->count] = m_store.record(segment.start + block->count);
+
+		segment.start += block->count;
+		segment.count -= block->count;
+		m_queued -= block->count;
+
+		m_delayedInBuffer -= std::min(m_delayedInBuffer, block->count);
+
+		block->endOfLog = segment.endOfLog && segment.count == 0;
+
+		if (segment.count == 0)
+			m_segments.pop(done);
+
+		submitBlock(block);
+	}
+}
+
+void Logging::Drain()
+{
+	if (m_writeMode != WriteMode::Background)
+		return;
+
+	for (;;)
+	{
+		FlushLog(false);
+
+		std::unique_lock lock(m_queueMutex);
+
+		if (m_segments.empty())
+		{
+			m_drainCondition.wait(lock, [this] { return m_pendingBlocks.empty() && ! m_writerBusy; });
+			return;
+		}
+
+		m_drainCondition.wait(lock, [this] { return ! m_freeBlocks.empty(); });
+	}
+}
+
+Logging::Stats Logging::GetStats() const
+{
+	return {
+		m_samplesWritten,
+		m_samplesDelayed,
+		m_samplesDropped,
+	};
+}
+
+void Logging::dropOverwritten()
+{
+	for (size_t n = 0; n < m_segments.size(); n++)
+	{
+		auto& segment = m_segments[n];
+
+		if (segment.count == 0)
+			continue;
+
+		// Later segments hold newer samples
+		if (m_store.contains(segment.start))
+			return;
+
+		const size_t lost = std::min<size_t>(segment.count, m_store.first() - segment.start);
+
+		segment.start += lost;
+		segment.count -= lost;
+		m_queued -= lost;
+		m_samplesDropped += lost;
+
+		m_delayedInBuffer -= std::min(m_delayedInBuffer, lost);
+	}
+}
+
+Logging::Block* Logging::acquireBlock()
+{
+	if (m_writeMode == WriteMode::Synchronous)
+		return &m_blocks.front();
+
+	std::lock_guard lock(m_queueMutex);
+
+	Block* block = nullptr;
+	m_freeBlocks.pop(block);
+
+	return block;
+}
+
+void Logging::submitBlock(Block* block)
+{
+	if (m_writeMode == WriteMode::Synchronous)
+	{
+		writeBlock(*block);
+		return;
+	}
+
+	{
+		std::lock_guard lock(m_queueMutex);
+		m_pendingBlocks.push(block);
+	}
+
+	m_queueCondition.notify_one();
+}
+
+void Logging::writerTask()
+{
+	std::unique_lock lock(m_queueMutex);
+
+	for (;;)
+	{
+		m_queueCondition.wait(lock, [this] { return ! m_pendingBlocks.empty() || m_stopWriter; });
+
+		Block* block = nullptr;
+		if (! m_pendingBlocks.pop(block))
+			break;
+
+		m_writerBusy = true;
+		lock.unlock();
+
+		writeBlock(*block);
+
+		lock.lock();
+		m_writerBusy = false;
+		m_freeBlocks.push(block);
+
+		m_drainCondition.notify_all();
+	}
+}
+
+void Logging::writeBlock(const Block& block)
+{
+	// The end of a log whose samples were all written or dropped already, or that had none.
+	// Files are only opened for a block with samples, which also starts the log's time base.
+	if (block.count == 0 && ! m_fileStream.is_open())
+		return;
+
+	if (m_fileFormat == FileFormat::Binary)
+		writeBinary(block);
+	else
+		writeCsv(block);
+
+	m_samplesWritten += block.count;
+
+	if (block.endOfLog)
+	{
+		m_fileStream.close();
+		++m_logCount;
+	}
+}
+
+void Logging::writeCsv(const Block& block)
 {
 	if (! m_fileStream.is_open())
 	{
 		m_fileStream.open("logs/" + m_fileName + std::to_string(m_logCount) + ".csv");
 
-		m_fileStream << "Seconds, Temperature, Pressure\n";
+		ShotLogFormat::WriteCsvHeader(m_fileStream);
 		m_fileStream.flush();
+
+		m_logStartMs = block.samples[0].timeMs;
 	}
 
-	for (auto n = 0; n < m_data.size(); n++)
+	for (size_t n = 0; n < block.count; n++)
 	{
 		// write to file
-		const auto& [temperature, pressure] = m_data[n];
-		m_fileStream << float(m_dataPointsTotal + n) / 10.0f << ", " << temperature << ", " << pressure / 20 << '\n';
+		const auto& record = block.samples[n];
+		ShotLogFormat::WriteCsvRow(m_fileStream, record.timeMs - m_logStartMs, to_log_sample(record));
 	}
 
 	m_fileStream.flush();
+}
 
-	m_dataPointsTotal += m_data.size();
+void Logging::writeBinary(const Block& block)
+{
+	auto* out = m_encodeBuffer.data();
+	size_t length = 0;
 
-	if (newFile)
+	if (! m_fileStream.is_open())
 	{
-		m_fileStream.close();
-		++m_logCount;
-		m_dataPointsTotal = 0;
+		m_fileStream.open("logs/" + m_fileName + std::to_string(m_logCount) + ".esl", std::ios::binary);
+		length += m_encoder.encodeHeader(out);
 	}
 
-	m_data.clear();
+	for (size_t n = 0; n < block.count; n++)
+	{
+		const auto& record = block.samples[n];
+		length += m_encoder.encodeSample(record.timeMs, to_log_sample(record), out + length);
+	}
+
+	m_fileStream.write(reinterpret_cast<const char*>(out), length);
+	m_fileStream.flush();
 }
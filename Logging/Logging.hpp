@@ -1,34 +1,134 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <string>
-#include <vector>
 #include <fstream>
+#include <thread>
 
+#include "RingBuffer.hpp"
+#include "ShotLogFormat.hpp"
+#include "TelemetryStore.hpp"
+
+// Writes samples from a TelemetryStore to shot logs. Queued samples stay in the store until a
+// block is free, they are only copied into the block handed to the writer.
 class Logging
 {
 public:
-	Logging(bool autoFlush, const std::string& fileSuffix);
-	~Logging() = default;
+	enum class WriteMode
+	{
+		Synchronous,	// Samples are formatted and written on the calling thread
+		Background,		// Filled blocks are queued to a dedicated writer thread
+	};
+
+	enum class FileFormat
+	{
+		Csv,
+		Binary,		// See ShotLogFormat, convert with ShotLogReader::ConvertToCsv
+	};
+
+	Logging(const TelemetryStore& store,
+		bool autoFlush,
+		const std::string& fileSuffix,
+		WriteMode mode = WriteMode::Synchronous,
+		FileFormat format = FileFormat::Csv,
+		uint16_t samplePeriodMs = kDefaultSamplePeriodMs);
+	~Logging();
+
+	static constexpr uint16_t kDefaultSamplePeriodMs = 100;
 
-	using DataPoint = std::pair<float, float>;
+	// Queued samples handed to the writer at once, ~10 seconds at 50 Hz. The store keeps
+	// several times as many, which is the slack for a writer that falls behind.
+	static constexpr size_t kFlushThreshold = 512;
 
-	void AddData(const DataPoint& data)
+	// Blocks handed to the writer. Bounds the samples in flight to kBlockCount * kBlockCapacity.
+	static constexpr size_t kBlockCapacity = 128;
+	static constexpr size_t kBlockCount = 8;
+
+	// Runs of consecutive samples, one per log or more if a log skips samples, that can be queued
+	// while the writer is behind. Once they run out, samples that would start another run are
+	// dropped rather than waiting for the writer.
+	static constexpr size_t kMaxPendingSegments = 8;
+
+	struct Stats
 	{
-		m_data.push_back(data);
+		size_t samplesWritten;
+		size_t samplesDelayed;	// Left queued in the store because no free block was available
+		size_t samplesDropped;	// Overwritten in the store before a block was available, or no segment was free
+	};
 
-		if (m_autoFlush)
-			FlushLog(false);
-	}
+	// Queues the store's sample at index. Samples must be added in store order, a log may skip
+	// samples and the next log may start anywhere after FlushLog(). Doesn't wait for the writer.
+	void AddData(uint32_t index);
 
 	void FlushLog(bool newFile = true);
 
+	// Hands off everything still buffered and blocks until it has been written.
+	void Drain();
+
+	Stats GetStats() const;
+
 private:
+	struct Block
+	{
+		std::array<TelemetryStore::Record, kBlockCapacity> samples;
+		size_t count;
+		bool endOfLog;
+	};
+
+	// Consecutive queued samples of one log
+	struct Segment
+	{
+		uint32_t start;
+		size_t count;
+		bool endOfLog;		// The log ends with the segment's last sample
+	};
+
+	void dropOverwritten();
+
+	Block* acquireBlock();
+	void submitBlock(Block* block);
+	void writeBlock(const Block& block);
+	void writeCsv(const Block& block);
+	void writeBinary(const Block& block);
+	void writerTask();
+
 	bool m_autoFlush	= false;
-	size_t m_logCount	= 1;
-	size_t m_dataPointsTotal = 0;
+	uint16_t m_samplePeriodMs;
+	WriteMode m_writeMode;
+	FileFormat m_fileFormat;
+
+	const TelemetryStore& m_store;
+
+	// Samples and log ends not handed to the writer yet, oldest first. m_queued counts the
+	// samples across all segments.
+	RingBuffer<Segment, kMaxPendingSegments> m_segments;
+	size_t m_queued = 0;
 
-	std::vector<DataPoint> m_data;
 	std::string m_fileName;
+	size_t m_delayedInBuffer = 0;
 
+	// Owned by the writer; only touched from writerTask() in Background mode
+	size_t m_logCount	= 1;
+	uint32_t m_logStartMs = 0;
 	std::ofstream m_fileStream;
+	ShotLogEncoder m_encoder;
+	std::array<uint8_t, ShotLogFormat::kHeaderSize + kBlockCapacity * ShotLogFormat::kMaxSampleSize> m_encodeBuffer;
+
+	std::array<Block, kBlockCount> m_blocks;
+	RingBuffer<Block*, kBlockCount> m_freeBlocks;
+	RingBuffer<Block*, kBlockCount> m_pendingBlocks;
+	bool m_writerBusy = false;
+	bool m_stopWriter = false;
+
+	std::mutex m_queueMutex;
+	std::condition_variable m_queueCondition;
+	std::condition_variable m_drainCondition;
+	std::thread m_writerThread;
+
+	std::atomic<size_t> m_samplesWritten = 0;
+	std::atomic<size_t> m_samplesDelayed = 0;
+	std::atomic<size_t> m_samplesDropped = 0;
 };
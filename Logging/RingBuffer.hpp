@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+// Fixed capacity FIFO. Storage lives inside the object so nothing is allocated after construction.
+template<typename T, size_t Capacity>
+class RingBuffer
+{
+	static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	static constexpr size_t kCapacity = Capacity;
+
+	bool push(const T& value)
+	{
+		if (full())
+			return false;
+
+		m_storage[m_head & kMask] = value;
+		++m_head;
+
+		return true;
+	}
+
+	bool pop(T& value)
+	{
+		if (empty())
+			return false;
+
+		value = m_storage[m_tail & kMask];
+		++m_tail;
+
+		return true;
+	}
+
+	// Index relative to the oldest element.
+	T& operator[](size_t n)
+	{
+		return m_storage[(m_tail + n) & kMask];
+	}
+
+	const T& operator[](size_t n) const
+	{
+		return m_storage[(m_tail + n) & kMask];
+	}
+
+	// Newest element, the buffer must not be empty.
+	T& back()
+	{
+		return m_storage[(m_head - 1) & kMask];
+	}
+
+	void clear()
+	{
+		m_tail = m_head;
+	}
+
+	size_t size() const		{ return m_head - m_tail; }
+	bool empty() const		{ return m_head == m_tail; }
+	bool full() const		{ return size() == Capacity; }
+
+private:
+	static constexpr size_t kMask = Capacity - 1;
+
+	std::array<T, Capacity> m_storage;
+
+	size_t m_head = 0;
+	size_t m_tail = 0;
+};
@@ -0,0 +1,224 @@
+#include "ShotLogFormat.hpp"
+
+#include <ostream>
+
+namespace
+{
+	constexpr int32_t kPow10[] = { 1, 10, 100, 1000, 10000 };
+
+	uint32_t zigzag(int32_t value)
+	{
+		return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+	}
+
+	int32_t unzigzag(uint32_t value)
+	{
+		return static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+	}
+
+	size_t writeVarint(uint32_t value, uint8_t* out)
+	{
+		size_t n = 0;
+
+		while (value >= 0x80)
+		{
+			out[n++] = static_cast<uint8_t>(value) | 0x80;
+			value >>= 7;
+		}
+
+		out[n++] = static_cast<uint8_t>(value);
+
+		return n;
+	}
+
+	void writeFixed(std::ostream& out, int32_t fixed, uint8_t decimals)
+	{
+		// Widened so INT32_MIN from a damaged log can be negated
+		int64_t value = fixed;
+
+		if (value < 0)
+		{
+			out << '-';
+			value = -value;
+		}
+
+		out << value / kPow10[decimals];
+
+		if (decimals == 0)
+			return;
+
+		auto fraction = std::to_string(value % kPow10[decimals]);
+		out << '.' << std::string(decimals - fraction.size(), '0') << fraction;
+	}
+}
+
+void ShotLogFormat::WriteCsvHeader(std::ostream& out, size_t channelCount)
+{
+	out << "Seconds";
+
+	for (size_t channel = 0; channel < channelCount; channel++)
+		out << ", " << kChannelNames[channel];
+
+	out << '\n';
+}
+
+void ShotLogFormat::WriteCsvRow(std::ostream& out, uint32_t timeMs, const Sample& sample, size_t channelCount)
+{
+	out << float(timeMs) / 1000.0f;
+
+	for (size_t channel = 0; channel < channelCount; channel++)
+	{
+		out << ", ";
+		writeFixed(out, sample[channel], kChannelDecimals[channel]);
+	}
+
+	out << '\n';
+}
+
+ShotLogEncoder::ShotLogEncoder(uint16_t samplePeriodMs)
+	: m_samplePeriodMs(samplePeriodMs)
+{
+}
+
+size_t ShotLogEncoder::encodeHeader(uint8_t* out)
+{
+	m_previous = {};
+	m_firstSample = true;
+
+	out[0] = ShotLogFormat::kMagic & 0xFF;
+	out[1] = (ShotLogFormat::kMagic >> 8) & 0xFF;
+	out[2] = (ShotLogFormat::kMagic >> 16) & 0xFF;
+	out[3] = (ShotLogFormat::kMagic >> 24) & 0xFF;
+	out[4] = ShotLogFormat::kVersion;
+	out[5] = ShotLogFormat::ChannelCount;
+	out[6] = m_samplePeriodMs & 0xFF;
+	out[7] = m_samplePeriodMs >> 8;
+
+	for (size_t n = 0; n < ShotLogFormat::ChannelCount; n++)
+		out[8 + n] = ShotLogFormat::kChannelDecimals[n];
+
+	return ShotLogFormat::kHeaderSize;
+}
+
+size_t ShotLogEncoder::encodeSample(uint32_t timeMs, const ShotLogFormat::Sample& sample, uint8_t* out)
+{
+	// On time samples store 0, the first sample defines time 0
+	const int32_t jitterMs = m_firstSample ? 0 : static_cast<int32_t>(timeMs - m_previousTimeMs) - m_samplePeriodMs;
+	m_previousTimeMs = timeMs;
+	m_firstSample = false;
+
+	size_t n = writeVarint(zigzag(jitterMs), out);
+
+	for (size_t channel = 0; channel < ShotLogFormat::ChannelCount; channel++)
+	{
+		// Deltas wrap like the reader's sums, so any int32 value round trips
+		const auto delta = static_cast<uint32_t>(sample[channel]) - static_cast<uint32_t>(m_previous[channel]);
+		n += writeVarint(zigzag(static_cast<int32_t>(delta)), out + n);
+		m_previous[channel] = sample[channel];
+	}
+
+	return n;
+}
+
+ShotLogReader::ShotLogReader(const std::string& path)
+	: m_file(path, std::ios::binary)
+{
+	uint8_t header[ShotLogFormat::kHeaderSize];
+
+	if (! m_file.read(reinterpret_cast<char*>(header), 8))
+		return;
+
+	const uint32_t magic = header[0] | header[1] << 8 | header[2] << 16 | uint32_t(header[3]) << 24;
+
+	// Older versions log a prefix of today's channels
+	if (magic != ShotLogFormat::kMagic || header[4] == 0 || header[4] > ShotLogFormat::kVersion || header[5] == 0 || header[5] > ShotLogFormat::ChannelCount)
+		return;
+
+	if (! m_file.read(reinterpret_cast<char*>(header + 8), header[5]))
+		return;
+
+	for (size_t n = 0; n < header[5]; n++)
+	{
+		if (header[8 + n] != ShotLogFormat::kChannelDecimals[n])
+			return;
+	}
+
+	m_version = header[4];
+	m_channelCount = header[5];
+	m_samplePeriodMs = header[6] | header[7] << 8;
+	m_valid = true;
+}
+
+bool ShotLogReader::next(uint32_t& timeMs, ShotLogFormat::Sample& sample)
+{
+	if (! m_valid)
+		return false;
+
+	int32_t jitterMs = 0;
+
+	if (m_version >= ShotLogFormat::kFirstTimedVersion)
+	{
+		uint32_t jitter;
+		if (! readVarint(jitter))
+			return false;
+
+		jitterMs = unzigzag(jitter);
+	}
+
+	m_timeMs = m_firstSample ? 0 : m_timeMs + m_samplePeriodMs + jitterMs;
+	m_firstSample = false;
+
+	for (size_t channel = 0; channel < m_channelCount; channel++)
+	{
+		uint32_t delta;
+		if (! readVarint(delta))
+			return false;
+
+		m_previous[channel] = static_cast<int32_t>(static_cast<uint32_t>(m_previous[channel]) + static_cast<uint32_t>(unzigzag(delta)));
+	}
+
+	sample = m_previous;
+	timeMs = m_timeMs;
+
+	return true;
+}
+
+bool ShotLogReader::readVarint(uint32_t& value)
+{
+	value = 0;
+
+	for (size_t n = 0; n < ShotLogFormat::kMaxVarintSize; n++)
+	{
+		const auto byte = m_file.get();
+
+		if (byte == std::char_traits<char>::eof())
+			return false;
+
+		value |= static_cast<uint32_t>(byte & 0x7F) << (7 * n);
+
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+bool ShotLogReader::ConvertToCsv(const std::string& binaryPath, const std::string& csvPath)
+{
+	ShotLogReader reader(binaryPath);
+
+	if (! reader.isValid())
+		return false;
+
+	std::ofstream csv(csvPath);
+
+	ShotLogFormat::WriteCsvHeader(csv, reader.channelCount());
+
+	ShotLogFormat::Sample sample;
+	uint32_t timeMs;
+
+	while (reader.next(timeMs, sample))
+		ShotLogFormat::WriteCsvRow(csv, timeMs, sample, reader.channelCount());
+
+	return csv.good();
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Binary shot log (.esl)
+//
+// Header, little endian:
+//   u32 magic 'ESPL' | u8 version | u8 channel count | u16 sample period (ms) | u8 decimal places per channel
+//
+// Followed by one record per sample, each value zigzagged and written as a LEB128 varint:
+//   time: milliseconds since the previous sample minus the sample period (version 2 onwards)
+//   channels: fixed point value (value * 10^decimals), delta encoded against the previous sample
+// The first sample is at time 0. Version 1 logs have no time field, their samples are exactly
+// one sample period apart. Versions 1 and 2 only have the temperature and pressure channels,
+// version 3 adds weight, flow and boiler state. A steady shot costs 6-8 bytes per sample.
+struct ShotLogFormat
+{
+	static constexpr uint32_t kMagic = 0x4C505345;
+	static constexpr uint8_t kVersion = 3;
+	static constexpr uint8_t kFirstTimedVersion = 2;
+
+	enum Channel
+	{
+		Temperature,
+		Pressure,
+		Weight,		// -999.9 without scales
+		Flow,
+		State,		// BoilerState
+		ChannelCount
+	};
+
+	static constexpr std::array<const char*, ChannelCount> kChannelNames = { "Temperature", "Pressure", "Weight", "Flow", "State" };
+	static constexpr std::array<uint8_t, ChannelCount> kChannelDecimals = { 2, 3, 1, 2, 0 };
+
+	static constexpr size_t kHeaderSize = 8 + ChannelCount;
+	static constexpr size_t kMaxVarintSize = 5;
+	static constexpr size_t kMaxSampleSize = (1 + ChannelCount) * kMaxVarintSize;
+
+	using Sample = std::array<int32_t, ChannelCount>;
+
+	// CSV layout shared by Logging and ShotLogReader::ConvertToCsv, with the first channelCount
+	// channels. timeMs is the time since the first sample.
+	static void WriteCsvHeader(std::ostream& out, size_t channelCount = ChannelCount);
+	static void WriteCsvRow(std::ostream& out, uint32_t timeMs, const Sample& sample, size_t channelCount = ChannelCount);
+};
+
+class ShotLogEncoder
+{
+public:
+	explicit ShotLogEncoder(uint16_t samplePeriodMs);
+
+	// Writes the file header and resets the delta state. Returns bytes written.
+	size_t encodeHeader(uint8_t* out);
+
+	// timeMs is any monotonic millisecond clock, sample holds fixed point values. Returns bytes
+	// written, at most ShotLogFormat::kMaxSampleSize.
+	size_t encodeSample(uint32_t timeMs, const ShotLogFormat::Sample& sample, uint8_t* out);
+
+private:
+	uint16_t m_samplePeriodMs;
+	ShotLogFormat::Sample m_previous = {};
+	uint32_t m_previousTimeMs = 0;
+	bool m_firstSample = true;
+};
+
+class ShotLogReader
+{
+public:
+	explicit ShotLogReader(const std::string& path);
+
+	bool isValid() const { return m_valid; }
+	uint16_t samplePeriodMs() const { return m_samplePeriodMs; }
+	size_t channelCount() const { return m_channelCount; }
+
+	// Reads the next sample as fixed point values and its time since the first sample,
+	// returns false at the end of the log. Channels the log doesn't have read as 0.
+	bool next(uint32_t& timeMs, ShotLogFormat::Sample& sample);
+
+	// Rewrites a binary log in the CSV layout Logging produces.
+	static bool ConvertToCsv(const std::string& binaryPath, const std::string& csvPath);
+
+private:
+	bool readVarint(uint32_t& value);
+
+	std::ifstream m_file;
+	bool m_valid = false;
+	uint8_t m_version = 0;
+	uint16_t m_samplePeriodMs = 0;
+	size_t m_channelCount = 0;
+	ShotLogFormat::Sample m_previous = {};
+	uint32_t m_timeMs = 0;
+	bool m_firstSample = true;
+};
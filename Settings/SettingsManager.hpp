@@ -1,9 +1,22 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <condition_variable>
+#include <initializer_list>
+#include <mutex>
 #include <set>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <variant>
+#include <vector>
+
+#include "SettingsSchema.hpp"
+#include "SettingsView.hpp"
 
 struct SettingDelegate
 {
@@ -13,6 +26,15 @@ struct SettingDelegate
 	virtual void onChanged(const std::string& key, const std::string& val) { };
 };
 
+using SettingMask = std::bitset<kSettingCount>;
+
+// Receives at most one call per dispatch with every subscribed setting that changed since the
+// previous one. values holds the final value of each setting, intermediate values are skipped.
+struct SettingsBatchDelegate
+{
+	virtual void onSettingsChanged(const SettingMask& changed, const SettingsView& values) = 0;
+};
+
 class Setting
 {
 public:
@@ -21,16 +43,8 @@ public:
 	template<typename T>
 	Setting& operator=(const T& val)
 	{
-		try
-		{
-			if (std::get<T>(m_value) == val)
-				return *this;
-		}
-		catch (std::bad_variant_access& e)
-		{
-			// This will always occur when setting the initial value on a non-int setting. I'm too
-			// lazy to fix this.
-		}
+		if (auto* current = std::get_if<T>(&m_value); current != nullptr && *current == val)
+			return *this;
 
 		m_value = val;
 
@@ -78,29 +92,157 @@ public:
 	SettingsManager(const SettingsManager&) = delete;
 	SettingsManager& operator=(const SettingsManager&) = delete;
 
+	using Snapshot = std::vector<std::pair<std::string, Setting::SettingValue>>;
+
+	struct PersistenceStats
+	{
+		size_t savesRequested;
+		size_t savesWritten;
+	};
+
 	static SettingsManager& get()
 	{
 		static SettingsManager manager;
 		return manager;
 	}
 
-	Setting& operator[](const std::string& key)
+	Setting& operator[](SettingId id)
 	{
-		if (auto it = m_settings.find(key); it != m_settings.end())
-			return it->second;
+		return m_settings[static_cast<size_t>(id)];
+	}
+
+	template<SettingId Id>
+	SettingTypeOf<Id> value() const
+	{
+		return m_settings[static_cast<size_t>(Id)].template getAs<SettingTypeOf<Id>>();
+	}
+
+	// Safe to call from any thread. Readers never block on, or are blocked by, the UI thread
+	// writing settings. All other accessors must only be used from the UI thread.
+	SettingsView readSnapshot() const
+	{
+		return m_published.snapshot();
+	}
 
-		return m_settings[key];
+	template<SettingId Id>
+	SettingTypeOf<Id> read() const
+	{
+		return m_published.get<Id>();
 	}
 
+	void subscribe(SettingsBatchDelegate* delegate, std::initializer_list<SettingId> ids);
+	void unsubscribe(SettingsBatchDelegate* delegate);
+
+	// Delivers the changes collected since the previous call, call once per UI tick.
+	void dispatchChanges();
+
+	// Keys outside the schema are kept so they survive a load/save round trip.
+	Setting& operator[](std::string_view key)
+	{
+		if (auto id = findSettingId(key))
+			return (*this)[*id];
+
+		// Keys outside the schema aren't published, the persistence thread gets a copy of them
+		// on the next requestSave()
+		++m_extraSettingsVersion;
+
+		auto& setting = m_extraSettings[std::string(key)];
+		setting.setKey(std::string(key));
+
+		return setting;
+	}
+
+	// Sets a value read from storage. Schema settings keep their schema type, numbers of another
+	// type are converted and anything else is dropped, returning false. Keys outside the schema
+	// take the value as it is.
+	bool restore(std::string_view key, const Setting::SettingValue& value);
+
 	void loadDefaults(bool doSave = true);
 
-	// Must be implemented by SettingsManagerImpl
+	// Writes the current settings immediately on the calling thread.
 	void save();
+
+	// Marks the settings dirty. They are written from a background thread once no further
+	// request has arrived for the quiet period, so a slider drag results in a single write.
+	// The values are read on that thread when it writes, not here.
+	void requestSave();
+
+	// Writes any pending request immediately, call before shutting down.
+	void flush();
+
+	void setSaveQuietPeriod(std::chrono::milliseconds period);
+
+	PersistenceStats getPersistenceStats() const;
+
+	// Must be implemented by SettingsManagerImpl
 	void load();
 
+	// Implemented by the file backend
+	bool exportJson(const std::string& path) const;
+	bool importJson(const std::string& path);
+
 protected:
-	SettingsManager() = default;
+	SettingsManager();
+	~SettingsManager();
 
 private:
-	std::unordered_map<std::string, Setting> m_settings;
+	// Mirrors each schema setting into m_published as it changes
+	struct Publisher : public SettingDelegate
+	{
+		using SettingDelegate::onChanged;
+
+		void onChanged(const std::string&, const bool val) override
+		{
+			published->publish(id, val ? 1.0f : 0.0f);
+			changed->set(static_cast<size_t>(id));
+		}
+
+		void onChanged(const std::string&, const float val) override
+		{
+			published->publish(id, val);
+			changed->set(static_cast<size_t>(id));
+		}
+
+		SettingsPublisher* published = nullptr;
+		SettingMask* changed = nullptr;
+		SettingId id = SettingId::Count;
+	};
+
+	// Must be implemented by SettingsManagerImpl
+	void writeSnapshot(const Snapshot& snapshot);
+
+	Snapshot snapshot() const;
+	Snapshot extraSnapshot() const;
+	Snapshot publishedSnapshot(const Snapshot& extras) const;
+	void writePending();
+	void persistenceTask();
+
+	std::array<Setting, kSettingCount> m_settings;
+	std::unordered_map<std::string, Setting> m_extraSettings;
+
+	SettingsPublisher m_published;
+	std::array<Publisher, kSettingCount> m_publishers;
+
+	SettingMask m_changed;
+	std::vector<std::pair<SettingsBatchDelegate*, SettingMask>> m_subscribers;
+	bool m_dispatching = false;
+
+	// Bumped whenever a setting outside the schema may have been written
+	uint32_t m_extraSettingsVersion = 0;
+
+	// Guarded by m_persistMutex
+	Snapshot m_pendingExtras;
+	uint32_t m_pendingExtrasVersion = 0;
+	bool m_saveRequested = false;
+	bool m_stopPersistence = false;
+	std::chrono::milliseconds m_saveQuietPeriod = std::chrono::milliseconds(500);
+	std::chrono::steady_clock::time_point m_lastSaveRequest;
+
+	std::mutex m_persistMutex;
+	std::mutex m_writeMutex;
+	std::condition_variable m_persistCondition;
+	std::thread m_persistThread;
+
+	std::atomic<size_t> m_savesRequested = 0;
+	std::atomic<size_t> m_savesWritten = 0;
 };
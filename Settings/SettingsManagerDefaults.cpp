@@ -1,23 +1,82 @@
 #include "SettingsManager.hpp"
 
-void SettingsManager::loadDefaults(bool doSave)
+#include <cstdio>
+
+SettingsManager::SettingsManager()
 {
-	m_settings["BrewTemp"] = 93.0f;
-	m_settings["SteamTemp"] = 145.0f;
-	m_settings["BrewPressure"] = 9.0f;
+	for (const auto& entry: kSettingsSchema)
+	{
+		auto& publisher = m_publishers[static_cast<size_t>(entry.id)];
+		publisher.published = &m_published;
+		publisher.changed = &m_changed;
+		publisher.id = entry.id;
+
+		auto& setting = (*this)[entry.id];
+		setting.setKey(std::string(entry.name));
+		setting.registerDelegate(&publisher);
+	}
+}
 
-	m_settings["BoilerKp"] = 100.0f;
-	m_settings["BoilerKi"] = 10.0f;
-	m_settings["BoilerKd"] = 300.0f;
+void SettingsManager::loadDefaults(bool doSave)
+{
+	{
+		SettingsPublisher::Batch batch(m_published);
 
-	m_settings["PumpKp"] = 1.0f;
-	m_settings["PumpKi"] = 1.0f;
-	m_settings["PumpKd"] = 1.0f;
+		for (const auto& entry: kSettingsSchema)
+		{
+			switch (entry.type)
+			{
+			case SettingType::Bool:
+				(*this)[entry.id] = entry.defaultValue != 0.0f;
+				break;
 
-	m_settings["ManualPumpControl"] = 0.0f;
-	m_settings["ManualPumpControlEnabled"] = false;
-	m_settings["HotWaterModeEnabled"] = false;
+			case SettingType::Float:
+				(*this)[entry.id] = entry.defaultValue;
+				break;
+			}
+		}
+	}
 
 	if (doSave)
 		save();
 }
+
+bool SettingsManager::restore(std::string_view key, const Setting::SettingValue& value)
+{
+	const auto id = findSettingId(key);
+
+	if (! id)
+	{
+		std::visit([setting = &(*this)[key]](const auto& v) { *setting = v; }, value);
+		return true;
+	}
+
+	// A damaged record or one written by an older build, reading the setting would throw
+	// bad_variant_access if it was stored with another type
+	float number;
+
+	if (const auto* b = std::get_if<bool>(&value))
+		number = *b ? 1.0f : 0.0f;
+	else if (const auto* i = std::get_if<int64_t>(&value))
+		number = static_cast<float>(*i);
+	else if (const auto* f = std::get_if<float>(&value))
+		number = *f;
+	else
+	{
+		printf("Dropping stored %.*s, not a number\n", int(key.size()), key.data());
+		return false;
+	}
+
+	switch (schemaFor(*id).type)
+	{
+	case SettingType::Bool:
+		(*this)[*id] = number != 0.0f;
+		break;
+
+	case SettingType::Float:
+		(*this)[*id] = number;
+		break;
+	}
+
+	return true;
+}
@@ -1,27 +1,27 @@
 #include "SettingsManager.hpp"
 
-void SettingsManager::save()
+void SettingsManager::writeSnapshot(const Snapshot& snapshot)
 {
-	printf("%s - Saving %zu keys..\n", __PRETTY_FUNCTION__, m_settings.size());
+	printf("%s - Saving %zu keys..\n", __PRETTY_FUNCTION__, snapshot.size());
 
-	for (const auto& [key, value]: m_settings)
+	for (const auto& [key, value]: snapshot)
 	{
-		switch (value.get().index())
+		switch (value.index())
 		{
 		case 0:
-			printf("--> %s: %d\n", key.c_str(), value.getAs<bool>());
+			printf("--> %s: %d\n", key.c_str(), std::get<bool>(value));
 			break;
 
 		case 1:
-			printf("--> %s: %lld\n", key.c_str(), value.getAs<int64_t>());
+			printf("--> %s: %lld\n", key.c_str(), std::get<int64_t>(value));
 			break;
 
 		case 2:
-			printf("--> %s: %f\n", key.c_str(), value.getAs<float>());
+			printf("--> %s: %f\n", key.c_str(), std::get<float>(value));
 			break;
 
 		case 3:
-			printf("--> %s: %s\n", key.c_str(), value.getAs<std::string>().c_str());
+			printf("--> %s: %s\n", key.c_str(), std::get<std::string>(value).c_str());
 			break;
 		}
 	}
@@ -1,4 +1,5 @@
 #include "SettingsManager.hpp"
+#include "SettingsStorage.hpp"
 
 #include <iostream>
 #include <filesystem>
@@ -6,94 +7,169 @@
 
 #include "nlohmann/json.hpp"
 
+// Settings are stored as a binary snapshot (see SettingsStorage.hpp) which loads with a single
+// read and no exceptions. Settings.json is only read when there is no valid snapshot, e.g. the
+// first boot after updating, and can be produced on demand with exportJson().
+
+namespace fs = std::filesystem;
+
 namespace
 {
-	const auto kSettingsPath = "Settings.json";
+	const auto kSnapshotPath = "Settings.bin";
+	const auto kSnapshotTempPath = "Settings.bin.tmp";
+	const auto kSettingsJsonPath = "Settings.json";
+
+	bool loadSnapshot(SettingsManager& settings)
+	{
+		std::error_code ec;
+		const auto size = fs::file_size(kSnapshotPath, ec);
+
+		if (ec)
+			return false;
+
+		std::vector<uint8_t> data(size);
+
+		std::ifstream snapshotFile(kSnapshotPath, std::ios::binary);
+		if (! snapshotFile.read(reinterpret_cast<char*>(data.data()), data.size()))
+			return false;
+
+		return decodeSettingsSnapshot(data.data(), data.size(), settings);
+	}
+}
+
+void SettingsManager::writeSnapshot(const Snapshot& snapshot)
+{
+	const auto data = encodeSettingsSnapshot(snapshot);
+
+	{
+		std::ofstream snapshotFile(kSnapshotTempPath, std::ios::binary | std::ios::trunc);
+		snapshotFile.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+		if (! snapshotFile)
+		{
+			printf("Error writing %s\n", kSnapshotTempPath);
+			return;
+		}
+	}
+
+	// Replace the old file in one step so a power cut never leaves a half written snapshot
+	replaceSettingsFile(kSnapshotTempPath, kSnapshotPath);
 }
 
-void SettingsManager::save()
+void SettingsManager::load()
 {
-	std::ofstream settingsFile(kSettingsPath);
+	// Controller threads keep seeing the previous values until loading has finished
+	SettingsPublisher::Batch batch(m_published);
+
+	loadDefaults(false);
+
+	if (loadSnapshot(*this))
+		return;
+
+	printf("No valid %s, importing %s..\n", kSnapshotPath, kSettingsJsonPath);
+
+	if (importJson(kSettingsJsonPath))
+	{
+		save();
+		return;
+	}
+
+	printf("Restoring defaults..\n");
+	loadDefaults();
+}
 
+bool SettingsManager::exportJson(const std::string& path) const
+{
 	nlohmann::json settingsJSON;
 
 	//TODO: Less fragile system for encoding Type.. but meh this works.
-	for (const auto& [key, value]: m_settings)
+	for (const auto& [key, value]: snapshot())
 	{
-		switch (value.get().index())
+		switch (value.index())
 		{
 		case 0:
 			settingsJSON[key] = {
-				{"Type", value.get().index()},
-				{"Value", value.getAs<bool>()},
+				{"Type", value.index()},
+				{"Value", std::get<bool>(value)},
 			};
 			break;
 
 		case 1:
 			settingsJSON[key] = {
-				{"Type", value.get().index()},
-				{"Value", value.getAs<int64_t>()},
+				{"Type", value.index()},
+				{"Value", std::get<int64_t>(value)},
 			};
 			break;
 
 		case 2:
 			settingsJSON[key] = {
-				{"Type", value.get().index()},
-				{"Value", value.getAs<float>()},
+				{"Type", value.index()},
+				{"Value", std::get<float>(value)},
 			};
 			break;
 
 		case 3:
 			settingsJSON[key] = {
-				{"Type", value.get().index()},
-				{"Value", value.getAs<std::string>()},
+				{"Type", value.index()},
+				{"Value", std::get<std::string>(value)},
 			};
 			break;
 		}
 	}
 
+	std::ofstream settingsFile(path);
 	settingsFile << std::setw(4) << settingsJSON << std::endl;
+
+	return settingsFile.good();
 }
 
-void SettingsManager::load()
+bool SettingsManager::importJson(const std::string& path)
 {
-	loadDefaults(false);
-
-	std::ifstream settingsFile(kSettingsPath);
+	std::ifstream settingsFile(path);
 	nlohmann::json settingsJSON;
 
+	if (! settingsFile)
+		return false;
+
 	try
 	{
 		settingsFile >> settingsJSON;
 
 		for (const auto& [key, value]: settingsJSON.items())
 		{
-			m_settings[key].setKey(key);
+			Setting::SettingValue setting;
 
 			switch (value["Type"].get<int>())
 			{
 			case 0:
-				m_settings[key] = value["Value"].get<bool>();
+				setting = value["Value"].get<bool>();
 				break;
 
 			case 1:
-				m_settings[key] = value["Value"].get<int64_t>();
+				setting = value["Value"].get<int64_t>();
 				break;
 
 			case 2:
-				m_settings[key] = value["Value"].get<float>();
+				setting = value["Value"].get<float>();
 				break;
 
 			case 3:
-				m_settings[key] = value["Value"].get<std::string>();
+				setting = value["Value"].get<std::string>();
 				break;
+
+			default:
+				continue;
 			}
+
+			restore(key, setting);
 		}
 	}
 	catch (std::exception& e)
 	{
-		printf("Error loading Settings.json, restoring defaults..\n");
+		printf("Error loading %s\n", path.c_str());
 		printf("\t%s\n", e.what());
-		loadDefaults();
+		return false;
 	}
+
+	return true;
 }
@@ -0,0 +1,125 @@
+#include "SettingsManager.hpp"
+#include "SettingsStorage.hpp"
+
+#include <fstream>
+#include <iterator>
+
+// Append-only settings store. Every write appends one record (see SettingsStorage.hpp) per
+// changed key. load() replays the records in order, the last record for a key wins. A record cut short
+// by a power loss fails its length or checksum check and everything from it onwards is
+// discarded. Once the journal grows past kCompactThreshold it is rewritten as a snapshot
+// holding a single record per key.
+
+namespace
+{
+	const auto kJournalPath = "Settings.journal";
+	const auto kJournalTempPath = "Settings.journal.tmp";
+
+	constexpr size_t kCompactThreshold = 4096;
+
+	std::unordered_map<std::string, Setting::SettingValue> s_persisted;
+	size_t s_journalSize = 0;
+
+	bool compact(const std::unordered_map<std::string, Setting::SettingValue>& values)
+	{
+		std::vector<uint8_t> records;
+
+		for (const auto& [key, value]: values)
+			appendSettingRecord(records, key, value);
+
+		{
+			std::ofstream journal(kJournalTempPath, std::ios::binary | std::ios::trunc);
+			journal.write(reinterpret_cast<const char*>(records.data()), records.size());
+
+			if (! journal)
+			{
+				printf("Error writing %s\n", kJournalTempPath);
+				return false;
+			}
+		}
+
+		if (! replaceSettingsFile(kJournalTempPath, kJournalPath))
+			return false;
+
+		s_journalSize = records.size();
+
+		return true;
+	}
+}
+
+void SettingsManager::writeSnapshot(const Snapshot& snapshot)
+{
+	std::vector<uint8_t> records;
+
+	for (const auto& [key, value]: snapshot)
+	{
+		if (auto it = s_persisted.find(key); it != s_persisted.end() && it->second == value)
+			continue;
+
+		if (appendSettingRecord(records, key, value))
+			s_persisted[key] = value;
+	}
+
+	if (records.empty())
+		return;
+
+	if (s_journalSize + records.size() > kCompactThreshold && compact(s_persisted))
+		return;
+
+	std::ofstream journal(kJournalPath, std::ios::binary | std::ios::app);
+	journal.write(reinterpret_cast<const char*>(records.data()), records.size());
+	journal.flush();
+
+	s_journalSize += records.size();
+}
+
+void SettingsManager::load()
+{
+	// Controller threads keep seeing the previous values until loading has finished
+	SettingsPublisher::Batch batch(m_published);
+
+	loadDefaults(false);
+
+	s_persisted.clear();
+	s_journalSize = 0;
+
+	std::ifstream journal(kJournalPath, std::ios::binary);
+
+	if (! journal)
+	{
+		printf("No settings journal, restoring defaults..\n");
+		loadDefaults();
+		return;
+	}
+
+	const std::vector<uint8_t> data((std::istreambuf_iterator<char>(journal)), std::istreambuf_iterator<char>());
+
+	size_t pos = 0;
+	std::string key;
+	Setting::SettingValue value;
+
+	while (pos < data.size())
+	{
+		const auto length = parseSettingRecord(data.data() + pos, data.size() - pos, key, value);
+
+		if (length == 0)
+			break;
+
+		s_persisted[key] = value;
+		pos += length;
+	}
+
+	for (const auto& [key, value]: s_persisted)
+		restore(key, value);
+
+	s_journalSize = data.size();
+
+	if (pos != data.size())
+	{
+		printf("Discarding %zu bytes of damaged settings journal\n", data.size() - pos);
+		compact(s_persisted);
+	}
+
+	// Pick up keys added to loadDefaults since the journal was written
+	save();
+}
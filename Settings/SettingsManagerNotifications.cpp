@@ -0,0 +1,71 @@
+#include "SettingsManager.hpp"
+
+#include <algorithm>
+
+void SettingsManager::subscribe(SettingsBatchDelegate* delegate, std::initializer_list<SettingId> ids)
+{
+	SettingMask mask;
+
+	for (auto id: ids)
+		mask.set(static_cast<size_t>(id));
+
+	auto it = std::find_if(m_subscribers.begin(), m_subscribers.end(), [delegate](const auto& subscriber) {
+		return subscriber.first == delegate;
+	});
+
+	if (it != m_subscribers.end())
+		it->second |= mask;
+	else
+		m_subscribers.emplace_back(delegate, mask);
+}
+
+void SettingsManager::unsubscribe(SettingsBatchDelegate* delegate)
+{
+	if (m_dispatching)
+	{
+		// Erasing would shift the subscribers dispatchChanges() hasn't reached yet, the entry is
+		// removed once it returns
+		for (auto& subscriber: m_subscribers)
+		{
+			if (subscriber.first == delegate)
+				subscriber.first = nullptr;
+		}
+
+		return;
+	}
+
+	m_subscribers.erase(std::remove_if(m_subscribers.begin(), m_subscribers.end(), [delegate](const auto& subscriber) {
+		return subscriber.first == delegate;
+	}), m_subscribers.end());
+}
+
+void SettingsManager::dispatchChanges()
+{
+	if (m_changed.none())
+		return;
+
+	// Changes made by a delegate while dispatching are delivered on the next call
+	const auto changed = m_changed;
+	m_changed.reset();
+
+	const auto values = readSnapshot();
+
+	// Delegates may subscribe or unsubscribe, themselves or others, from onSettingsChanged()
+	m_dispatching = true;
+
+	for (size_t n = 0; n < m_subscribers.size(); n++)
+	{
+		const auto [delegate, mask] = m_subscribers[n];
+
+		if (delegate == nullptr)
+			continue;
+
+		if (const auto relevant = changed & mask; relevant.any())
+			delegate->onSettingsChanged(relevant, values);
+	}
+
+	m_dispatching = false;
+
+	// Removes the entries unsubscribed during the dispatch
+	unsubscribe(nullptr);
+}
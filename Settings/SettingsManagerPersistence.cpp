@@ -0,0 +1,165 @@
+#include "SettingsManager.hpp"
+
+SettingsManager::~SettingsManager()
+{
+	if (m_persistThread.joinable())
+	{
+		{
+			std::lock_guard lock(m_persistMutex);
+			m_stopPersistence = true;
+		}
+
+		m_persistCondition.notify_one();
+		m_persistThread.join();
+	}
+
+	flush();
+}
+
+void SettingsManager::save()
+{
+	std::lock_guard writeLock(m_writeMutex);
+
+	{
+		// Anything pending is older than what is about to be written
+		std::lock_guard lock(m_persistMutex);
+		m_saveRequested = false;
+	}
+
+	writeSnapshot(snapshot());
+	++m_savesWritten;
+}
+
+void SettingsManager::requestSave()
+{
+	++m_savesRequested;
+
+	{
+		std::lock_guard lock(m_persistMutex);
+
+		// Schema settings are read from m_published once the quiet period is over, the rest
+		// are only copied when they may have changed, which in practice is never after load()
+		if (m_pendingExtrasVersion != m_extraSettingsVersion)
+		{
+			m_pendingExtras = extraSnapshot();
+			m_pendingExtrasVersion = m_extraSettingsVersion;
+		}
+
+		m_saveRequested = true;
+		m_lastSaveRequest = std::chrono::steady_clock::now();
+
+		if (! m_persistThread.joinable())
+			m_persistThread = std::thread(&SettingsManager::persistenceTask, this);
+	}
+
+	m_persistCondition.notify_one();
+}
+
+void SettingsManager::flush()
+{
+	writePending();
+}
+
+void SettingsManager::setSaveQuietPeriod(std::chrono::milliseconds period)
+{
+	std::lock_guard lock(m_persistMutex);
+	m_saveQuietPeriod = period;
+}
+
+SettingsManager::PersistenceStats SettingsManager::getPersistenceStats() const
+{
+	return {
+		m_savesRequested,
+		m_savesWritten,
+	};
+}
+
+SettingsManager::Snapshot SettingsManager::snapshot() const
+{
+	Snapshot snapshot;
+	snapshot.reserve(kSettingCount + m_extraSettings.size());
+
+	for (const auto& entry: kSettingsSchema)
+		snapshot.emplace_back(entry.name, m_settings[static_cast<size_t>(entry.id)].get());
+
+	for (const auto& [key, value]: m_extraSettings)
+		snapshot.emplace_back(key, value.get());
+
+	return snapshot;
+}
+
+SettingsManager::Snapshot SettingsManager::extraSnapshot() const
+{
+	Snapshot snapshot;
+	snapshot.reserve(m_extraSettings.size());
+
+	for (const auto& [key, value]: m_extraSettings)
+		snapshot.emplace_back(key, value.get());
+
+	return snapshot;
+}
+
+// Same as snapshot(), safe to call from any thread
+SettingsManager::Snapshot SettingsManager::publishedSnapshot(const Snapshot& extras) const
+{
+	const auto values = m_published.snapshot();
+
+	Snapshot snapshot;
+	snapshot.reserve(kSettingCount + extras.size());
+
+	for (const auto& entry: kSettingsSchema)
+	{
+		const auto value = values.values[static_cast<size_t>(entry.id)];
+
+		if (entry.type == SettingType::Bool)
+			snapshot.emplace_back(entry.name, value != 0.0f);
+		else
+			snapshot.emplace_back(entry.name, value);
+	}
+
+	snapshot.insert(snapshot.end(), extras.begin(), extras.end());
+
+	return snapshot;
+}
+
+void SettingsManager::writePending()
+{
+	// Writes are serialised so an older snapshot can never land after a newer one
+	std::lock_guard writeLock(m_writeMutex);
+
+	Snapshot extras;
+
+	{
+		std::lock_guard lock(m_persistMutex);
+
+		if (! m_saveRequested)
+			return;
+
+		extras = m_pendingExtras;
+		m_saveRequested = false;
+	}
+
+	writeSnapshot(publishedSnapshot(extras));
+	++m_savesWritten;
+}
+
+void SettingsManager::persistenceTask()
+{
+	std::unique_lock lock(m_persistMutex);
+
+	while (! m_stopPersistence)
+	{
+		m_persistCondition.wait(lock, [this] { return m_saveRequested || m_stopPersistence; });
+
+		// Keep waiting while requests are still arriving
+		while (! m_stopPersistence && std::chrono::steady_clock::now() < m_lastSaveRequest + m_saveQuietPeriod)
+			m_persistCondition.wait_until(lock, m_lastSaveRequest + m_saveQuietPeriod);
+
+		if (m_stopPersistence)
+			break;
+
+		lock.unlock();
+		writePending();
+		lock.lock();
+	}
+}
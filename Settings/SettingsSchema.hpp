@@ -0,0 +1,100 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+
+// Every setting the firmware knows about. Adding a key means adding an id here and an
+// entry at the same position in kSettingsSchema.
+enum class SettingId : uint8_t
+{
+	BrewTemp,
+	SteamTemp,
+	BrewPressure,
+
+	BoilerKp,
+	BoilerKi,
+	BoilerKd,
+
+	PumpKp,
+	PumpKi,
+	PumpKd,
+
+	ManualPumpControl,
+	ManualPumpControlEnabled,
+	HotWaterModeEnabled,
+
+	Count
+};
+
+constexpr size_t kSettingCount = static_cast<size_t>(SettingId::Count);
+
+// Values match the index of the type in Setting::SettingValue
+enum class SettingType : uint8_t
+{
+	Bool	= 0,
+	Float	= 2,
+};
+
+struct SettingSchema
+{
+	SettingId id;
+	std::string_view name;
+	SettingType type;
+	float defaultValue;
+	float min;
+	float max;
+};
+
+constexpr std::array<SettingSchema, kSettingCount> kSettingsSchema = {{
+	{ SettingId::BrewTemp,					"BrewTemp",					SettingType::Float,	93.0f,	85.0f,	100.0f },
+	{ SettingId::SteamTemp,					"SteamTemp",				SettingType::Float,	145.0f,	120.0f,	150.0f },
+	{ SettingId::BrewPressure,				"BrewPressure",				SettingType::Float,	9.0f,	6.0f,	12.0f },
+
+	{ SettingId::BoilerKp,					"BoilerKp",					SettingType::Float,	100.0f,	1.0f,	500.0f },
+	{ SettingId::BoilerKi,					"BoilerKi",					SettingType::Float,	10.0f,	1.0f,	500.0f },
+	{ SettingId::BoilerKd,					"BoilerKd",					SettingType::Float,	300.0f,	1.0f,	500.0f },
+
+	{ SettingId::PumpKp,					"PumpKp",					SettingType::Float,	1.0f,	1.0f,	500.0f },
+	{ SettingId::PumpKi,					"PumpKi",					SettingType::Float,	1.0f,	1.0f,	500.0f },
+	{ SettingId::PumpKd,					"PumpKd",					SettingType::Float,	1.0f,	1.0f,	500.0f },
+
+	{ SettingId::ManualPumpControl,			"ManualPumpControl",		SettingType::Float,	0.0f,	0.0f,	100.0f },
+	{ SettingId::ManualPumpControlEnabled,	"ManualPumpControlEnabled",	SettingType::Bool,	0.0f,	0.0f,	1.0f },
+	{ SettingId::HotWaterModeEnabled,		"HotWaterModeEnabled",		SettingType::Bool,	0.0f,	0.0f,	1.0f },
+}};
+
+constexpr bool schemaIsOrdered()
+{
+	for (size_t n = 0; n < kSettingCount; n++)
+	{
+		if (static_cast<size_t>(kSettingsSchema[n].id) != n)
+			return false;
+	}
+
+	return true;
+}
+
+static_assert(schemaIsOrdered(), "kSettingsSchema entries must be in SettingId order");
+
+constexpr const SettingSchema& schemaFor(SettingId id)
+{
+	return kSettingsSchema[static_cast<size_t>(id)];
+}
+
+// Used when loading from storage, the hot path indexes by SettingId directly.
+constexpr std::optional<SettingId> findSettingId(std::string_view name)
+{
+	for (const auto& entry: kSettingsSchema)
+	{
+		if (entry.name == name)
+			return entry.id;
+	}
+
+	return std::nullopt;
+}
+
+template<SettingId Id>
+using SettingTypeOf = std::conditional_t<schemaFor(Id).type == SettingType::Bool, bool, float>;
@@ -0,0 +1,271 @@
+#include "SettingsStorage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	uint8_t checksum(const uint8_t* data, size_t length)
+	{
+		uint8_t sum = 0x5A;
+
+		for (size_t n = 0; n < length; n++)
+			sum = static_cast<uint8_t>((sum << 1 | sum >> 7) ^ data[n]);
+
+		return sum;
+	}
+
+	template<typename T>
+	void appendRaw(std::vector<uint8_t>& out, const T& value)
+	{
+		const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+		out.insert(out.end(), bytes, bytes + sizeof(T));
+	}
+
+	constexpr std::array<uint32_t, 256> makeCrcTable()
+	{
+		std::array<uint32_t, 256> table = {};
+
+		for (uint32_t n = 0; n < 256; n++)
+		{
+			uint32_t crc = n;
+
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+
+			table[n] = crc;
+		}
+
+		return table;
+	}
+
+	constexpr auto kCrcTable = makeCrcTable();
+
+	uint32_t crc32(const uint8_t* data, size_t length)
+	{
+		uint32_t crc = 0xFFFFFFFF;
+
+		for (size_t n = 0; n < length; n++)
+			crc = kCrcTable[(crc ^ data[n]) & 0xFF] ^ (crc >> 8);
+
+		return ~crc;
+	}
+}
+
+bool appendSettingRecord(std::vector<uint8_t>& out, std::string_view key, const Setting::SettingValue& value)
+{
+	if (key.size() > kMaxSettingKeyLength
+		|| (value.index() == 3 && std::get<std::string>(value).size() > kMaxSettingStringLength))
+	{
+		printf("Setting %.*s is too long to store, skipped\n", static_cast<int>(std::min<size_t>(key.size(), 32)), key.data());
+		return false;
+	}
+
+	const auto start = out.size();
+
+	out.push_back(static_cast<uint8_t>(key.size()));
+	out.insert(out.end(), key.begin(), key.end());
+	out.push_back(static_cast<uint8_t>(value.index()));
+
+	switch (value.index())
+	{
+	case 0:
+		out.push_back(std::get<bool>(value));
+		break;
+
+	case 1:
+		appendRaw(out, std::get<int64_t>(value));
+		break;
+
+	case 2:
+		appendRaw(out, std::get<float>(value));
+		break;
+
+	case 3:
+	{
+		const auto& str = std::get<std::string>(value);
+		appendRaw(out, static_cast<uint16_t>(str.size()));
+		out.insert(out.end(), str.begin(), str.end());
+		break;
+	}
+	}
+
+	out.push_back(checksum(out.data() + start, out.size() - start));
+
+	return true;
+}
+
+size_t parseSettingRecord(const uint8_t* data, size_t length, std::string& key, Setting::SettingValue& value)
+{
+	size_t pos = 0;
+
+	auto take = [&](size_t count) -> const uint8_t* {
+		if (length - pos < count)
+			return nullptr;
+
+		const auto* p = data + pos;
+		pos += count;
+		return p;
+	};
+
+	const auto* keyLength = take(1);
+	if (keyLength == nullptr)
+		return 0;
+
+	const auto* keyData = take(*keyLength);
+	const auto* type = take(1);
+	if (keyData == nullptr || type == nullptr)
+		return 0;
+
+	key.assign(reinterpret_cast<const char*>(keyData), *keyLength);
+
+	switch (*type)
+	{
+	case 0:
+	{
+		const auto* p = take(1);
+		if (p == nullptr)
+			return 0;
+
+		value = *p != 0;
+		break;
+	}
+
+	case 1:
+	{
+		int64_t v;
+		const auto* p = take(sizeof(v));
+		if (p == nullptr)
+			return 0;
+
+		std::memcpy(&v, p, sizeof(v));
+		value = v;
+		break;
+	}
+
+	case 2:
+	{
+		float v;
+		const auto* p = take(sizeof(v));
+		if (p == nullptr)
+			return 0;
+
+		std::memcpy(&v, p, sizeof(v));
+		value = v;
+		break;
+	}
+
+	case 3:
+	{
+		uint16_t strLength;
+		const auto* p = take(sizeof(strLength));
+		if (p == nullptr)
+			return 0;
+
+		std::memcpy(&strLength, p, sizeof(strLength));
+
+		const auto* str = take(strLength);
+		if (str == nullptr)
+			return 0;
+
+		value = std::string(reinterpret_cast<const char*>(str), strLength);
+		break;
+	}
+
+	default:
+		return 0;
+	}
+
+	const auto* sum = take(1);
+	if (sum == nullptr || *sum != checksum(data, pos - 1))
+		return 0;
+
+	return pos;
+}
+
+bool replaceSettingsFile(const char* tempPath, const char* path)
+{
+	std::error_code ec;
+	fs::rename(tempPath, path, ec);
+
+	if (ec)
+	{
+		// FAT refuses to rename over an existing file
+		fs::remove(path, ec);
+		fs::rename(tempPath, path, ec);
+	}
+
+	if (ec)
+		printf("Error replacing %s\n\t%s\n", path, ec.message().c_str());
+
+	return ! ec;
+}
+
+std::vector<uint8_t> encodeSettingsSnapshot(const SettingsManager::Snapshot& snapshot)
+{
+	std::vector<uint8_t> data(kSettingsSnapshotHeaderSize);
+	uint16_t count = 0;
+
+	for (const auto& [key, value]: snapshot)
+	{
+		if (appendSettingRecord(data, key, value))
+			++count;
+	}
+
+	const uint16_t version = kSettingsSnapshotVersion;
+	const uint32_t payloadSize = static_cast<uint32_t>(data.size() - kSettingsSnapshotHeaderSize);
+	const uint32_t crc = crc32(data.data() + kSettingsSnapshotHeaderSize, payloadSize);
+
+	std::memcpy(data.data(), &kSettingsSnapshotMagic, 4);
+	std::memcpy(data.data() + 4, &version, 2);
+	std::memcpy(data.data() + 6, &count, 2);
+	std::memcpy(data.data() + 8, &payloadSize, 4);
+	std::memcpy(data.data() + 12, &crc, 4);
+
+	return data;
+}
+
+bool decodeSettingsSnapshot(const uint8_t* data, size_t length, SettingsManager& settings)
+{
+	if (length < kSettingsSnapshotHeaderSize)
+		return false;
+
+	uint32_t magic, payloadSize, crc;
+	uint16_t version, count;
+
+	std::memcpy(&magic, data, 4);
+	std::memcpy(&version, data + 4, 2);
+	std::memcpy(&count, data + 6, 2);
+	std::memcpy(&payloadSize, data + 8, 4);
+	std::memcpy(&crc, data + 12, 4);
+
+	const auto* payload = data + kSettingsSnapshotHeaderSize;
+
+	if (magic != kSettingsSnapshotMagic
+		|| version != kSettingsSnapshotVersion
+		|| payloadSize != length - kSettingsSnapshotHeaderSize
+		|| crc != crc32(payload, payloadSize))
+	{
+		return false;
+	}
+
+	std::string key;
+	Setting::SettingValue value;
+
+	for (size_t pos = 0, n = 0; n < count; n++)
+	{
+		const auto recordSize = parseSettingRecord(payload + pos, payloadSize - pos, key, value);
+
+		if (recordSize == 0)
+			return false;
+
+		settings.restore(key, value);
+		pos += recordSize;
+	}
+
+	return true;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "SettingsManager.hpp"
+
+// Encoding shared by the binary settings backends.
+//
+// Record:
+//   u8 key length | key | u8 type (variant index) | value | u8 checksum
+//
+// Snapshot, a header followed by one record per key:
+//   u32 magic 'ESST' | u16 version | u16 record count | u32 payload size | u32 CRC-32 of payload
+
+constexpr uint32_t kSettingsSnapshotMagic = 0x54535345;
+constexpr uint16_t kSettingsSnapshotVersion = 1;
+constexpr size_t kSettingsSnapshotHeaderSize = 16;
+
+// Longest key and string value a record can hold, the lengths are stored as u8 and u16
+constexpr size_t kMaxSettingKeyLength = UINT8_MAX;
+constexpr size_t kMaxSettingStringLength = UINT16_MAX;
+
+// Returns false, appending nothing, if key or a string value is too long for a record.
+bool appendSettingRecord(std::vector<uint8_t>& out, std::string_view key, const Setting::SettingValue& value);
+
+// Returns the length of the record at data, or 0 if it is incomplete or corrupt.
+size_t parseSettingRecord(const uint8_t* data, size_t length, std::string& key, Setting::SettingValue& value);
+
+std::vector<uint8_t> encodeSettingsSnapshot(const SettingsManager::Snapshot& snapshot);
+
+// Applies every record to settings. Returns false if the header, checksum or a record is
+// invalid; the checksum is verified before anything is applied.
+bool decodeSettingsSnapshot(const uint8_t* data, size_t length, SettingsManager& settings);
+
+// Renames tempPath over path, falling back to remove + rename where the filesystem needs it.
+bool replaceSettingsFile(const char* tempPath, const char* path);
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "SettingsSchema.hpp"
+
+// Copy of every schema setting taken at a single point in time.
+struct SettingsView
+{
+	std::array<float, kSettingCount> values;
+
+	template<SettingId Id>
+	SettingTypeOf<Id> get() const
+	{
+		if constexpr (std::is_same_v<SettingTypeOf<Id>, bool>)
+			return values[static_cast<size_t>(Id)] != 0.0f;
+		else
+			return values[static_cast<size_t>(Id)];
+	}
+};
+
+// Publishes schema values from the UI thread to the controller threads.
+//
+// Two copies of the values are kept. The writer only ever modifies the copy readers are not
+// directed to, then flips m_current, so readers never wait for a write or a batch in progress.
+// Each copy carries a sequence number (odd while being written) which lets a reader detect the
+// rare case of being overtaken by two publishes and retry.
+//
+// Only one thread may write at a time; readers may run on any thread.
+class SettingsPublisher
+{
+public:
+	SettingsPublisher()
+	{
+		for (auto& buffer: m_buffers)
+		{
+			for (auto& value: buffer.values)
+				value.store(0.0f, std::memory_order_relaxed);
+		}
+	}
+
+	void publish(SettingId id, float value)
+	{
+		if (m_batchDepth == 0)
+			beginWrite();
+
+		m_buffers[m_writeIndex].values[static_cast<size_t>(id)].store(value, std::memory_order_relaxed);
+
+		if (m_batchDepth == 0)
+			endWrite();
+	}
+
+	// Groups the publishes made during its lifetime so readers observe all of them or none.
+	class Batch
+	{
+	public:
+		explicit Batch(SettingsPublisher& publisher)
+			: m_publisher(publisher)
+		{
+			m_publisher.beginBatch();
+		}
+
+		~Batch()
+		{
+			m_publisher.endBatch();
+		}
+
+		Batch(const Batch&) = delete;
+		Batch& operator=(const Batch&) = delete;
+
+	private:
+		SettingsPublisher& m_publisher;
+	};
+
+	void beginBatch()
+	{
+		if (m_batchDepth++ == 0)
+			beginWrite();
+	}
+
+	void endBatch()
+	{
+		if (--m_batchDepth == 0)
+			endWrite();
+	}
+
+	SettingsView snapshot() const
+	{
+		SettingsView view;
+
+		read([&view](const Buffer& buffer) {
+			for (size_t n = 0; n < kSettingCount; n++)
+				view.values[n] = buffer.values[n].load(std::memory_order_relaxed);
+		});
+
+		return view;
+	}
+
+	template<SettingId Id>
+	SettingTypeOf<Id> get() const
+	{
+		float value;
+
+		read([&value](const Buffer& buffer) {
+			value = buffer.values[static_cast<size_t>(Id)].load(std::memory_order_relaxed);
+		});
+
+		if constexpr (std::is_same_v<SettingTypeOf<Id>, bool>)
+			return value != 0.0f;
+		else
+			return value;
+	}
+
+private:
+	struct Buffer
+	{
+		std::atomic<uint32_t> sequence = 0;
+		std::array<std::atomic<float>, kSettingCount> values;
+	};
+
+	void beginWrite()
+	{
+		const auto current = m_current.load(std::memory_order_relaxed);
+		m_writeIndex = current ^ 1;
+
+		auto& target = m_buffers[m_writeIndex];
+		target.sequence.store(target.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (size_t n = 0; n < kSettingCount; n++)
+			target.values[n].store(m_buffers[current].values[n].load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+
+	void endWrite()
+	{
+		auto& target = m_buffers[m_writeIndex];
+		target.sequence.store(target.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+		m_current.store(m_writeIndex, std::memory_order_release);
+	}
+
+	template<typename F>
+	void read(F&& copy) const
+	{
+		for (;;)
+		{
+			const auto& buffer = m_buffers[m_current.load(std::memory_order_acquire)];
+			const auto before = buffer.sequence.load(std::memory_order_acquire);
+
+			if (before & 1)
+				continue;
+
+			copy(buffer);
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+
+			if (buffer.sequence.load(std::memory_order_relaxed) == before)
+				return;
+		}
+	}
+
+	std::array<Buffer, 2> m_buffers;
+	std::atomic<uint32_t> m_current = 0;
+
+	// Writer state
+	uint32_t m_writeIndex = 0;
+	int m_batchDepth = 0;
+};
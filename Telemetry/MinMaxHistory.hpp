@@ -0,0 +1,119 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "RingBuffer.hpp"
+
+// Keeps a signal at several levels of detail. Level 0 holds the raw samples, every bucket on
+// level n holds the minimum and maximum of two consecutive buckets from level n - 1, so it covers
+// 2^n samples. Each level keeps its newest Capacity buckets, which bounds memory by
+// Levels * Capacity whatever the duration, while the top level still reaches back
+// Capacity * 2^(Levels - 1) samples.
+template<typename T, size_t Channels, size_t Levels, size_t Capacity>
+class MinMaxHistory
+{
+	static_assert(Levels > 0, "At least the raw level is needed");
+
+public:
+	static constexpr size_t kLevels = Levels;
+	static constexpr size_t kCapacity = Capacity;
+
+	using Sample = std::array<T, Channels>;
+
+	struct Bucket
+	{
+		Sample min;
+		Sample max;
+	};
+
+	// Returns how many levels received a new bucket, 1 when only the raw level did.
+	size_t push(const Sample& sample)
+	{
+		Bucket bucket { sample, sample };
+
+		++m_samples;
+
+		for (size_t level = 0; level < Levels; level++)
+		{
+			append(level, bucket);
+
+			if (level + 1 == Levels)
+				return Levels;
+
+			// Buckets on the next level are made from pairs of buckets on this one
+			auto& pending = m_pending[level + 1];
+
+			if (! pending.valid)
+			{
+				pending.bucket = bucket;
+				pending.valid = true;
+				return level + 1;
+			}
+
+			for (size_t n = 0; n < Channels; n++)
+			{
+				bucket.min[n] = std::min(pending.bucket.min[n], bucket.min[n]);
+				bucket.max[n] = std::max(pending.bucket.max[n], bucket.max[n]);
+			}
+
+			pending.valid = false;
+		}
+
+		return Levels;
+	}
+
+	void clear()
+	{
+		for (auto& level: m_levels)
+			level.clear();
+
+		for (auto& pending: m_pending)
+			pending.valid = false;
+
+		m_samples = 0;
+	}
+
+	size_t size(size_t level) const
+	{
+		return m_levels[level].size();
+	}
+
+	// Index relative to the oldest bucket kept on the level.
+	const Bucket& at(size_t level, size_t n) const
+	{
+		return m_levels[level][n];
+	}
+
+	uint64_t samples() const
+	{
+		return m_samples;
+	}
+
+private:
+	struct Pending
+	{
+		Bucket bucket;
+		bool valid = false;
+	};
+
+	void append(size_t level, const Bucket& bucket)
+	{
+		auto& buckets = m_levels[level];
+
+		if (buckets.full())
+		{
+			Bucket oldest;
+			buckets.pop(oldest);
+		}
+
+		buckets.push(bucket);
+	}
+
+	std::array<RingBuffer<Bucket, Capacity>, Levels> m_levels;
+	std::array<Pending, Levels> m_pending;
+
+	uint64_t m_samples = 0;
+};
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "BoilerController.hpp"
+#include "ScalesController.hpp"
+
+#include "TelemetryChannel.hpp"
+
+// Stands in as the controllers' delegate and republishes every callback on a channel, so
+// controller threads never touch LVGL and never wait on the UI. The UI, logger and any other
+// consumer create a Subscriber on the channels they need and drain them on their own thread.
+//
+// Each channel has a single producer: the controller thread that fires the matching callback.
+class TelemetryBus
+	: public BoilerTemperatureDelegate
+	, public ScalesWeightDelegate
+{
+public:
+	static constexpr size_t kChannelCapacity = 64;
+
+	using FloatChannel = TelemetryChannel<float, kChannelCapacity>;
+	using StateChannel = TelemetryChannel<BoilerState, kChannelCapacity>;
+
+	TelemetryBus(const TelemetryBus&) = delete;
+	TelemetryBus& operator=(const TelemetryBus&) = delete;
+
+	static TelemetryBus& get()
+	{
+		static TelemetryBus bus;
+		return bus;
+	}
+
+	// Registers with the controllers the first time it is called for each of them.
+	void attach(BoilerController* boiler, ScalesController* scales)
+	{
+		if (boiler != nullptr && boiler != m_boilerController)
+		{
+			m_boilerController = boiler;
+			m_boilerController->registerBoilerTemperatureDelegate(this);
+		}
+
+		if (scales != nullptr && scales != m_scalesController)
+		{
+			m_scalesController = scales;
+			m_scalesController->registerWeightDelegate(this);
+		}
+	}
+
+	// BoilerTemperatureDelegate i/f
+	void onBoilerCurrentTempChanged(float temp) override		{ boilerCurrentTemp.publish(temp); }
+	void onBoilerTargetTempChanged(float temp) override			{ boilerTargetTemp.publish(temp); }
+	void onBoilerStateChanged(BoilerState state) override		{ boilerState.publish(state); }
+	void onBoilerPressureChanged(float pressure) override		{ boilerPressure.publish(pressure); }
+
+	// ScalesWeightDelegate i/f
+	void onScalesWeightChanged(float weight) override			{ scalesWeight.publish(weight); }
+
+	FloatChannel boilerCurrentTemp;
+	FloatChannel boilerTargetTemp;
+	FloatChannel boilerPressure;
+	StateChannel boilerState;
+	FloatChannel scalesWeight;
+
+private:
+	TelemetryBus() = default;
+
+	BoilerController* m_boilerController = nullptr;
+	ScalesController* m_scalesController = nullptr;
+};
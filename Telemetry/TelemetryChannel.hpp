@@ -0,0 +1,153 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Lock-free broadcast ring with a single producer and any number of subscribers.
+//
+// The producer never waits: it overwrites the oldest slot whether or not every subscriber has
+// read it. Each Subscriber keeps its own cursor and reads samples straight out of the shared
+// ring, so adding a consumer costs no extra buffering. A subscriber that falls more than
+// Capacity samples behind skips ahead and counts what it missed in dropped().
+template<typename T, size_t Capacity>
+class TelemetryChannel
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Telemetry samples must be trivially copyable");
+	static_assert(Capacity > 1 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two above one");
+
+public:
+	// Indices start at firstIndex, only tests need anything but 0 to cover the indices wrapping.
+	explicit TelemetryChannel(uint32_t firstIndex = 0)
+		: m_head(firstIndex)
+	{
+		for (size_t n = 0; n < Capacity; n++)
+			m_slots[n].sequence.store(notReadable(static_cast<uint32_t>(n)), std::memory_order_relaxed);
+	}
+
+	TelemetryChannel(const TelemetryChannel&) = delete;
+	TelemetryChannel& operator=(const TelemetryChannel&) = delete;
+
+	// Producer side, must only be called from one thread.
+	void publish(const T& value)
+	{
+		const auto index = m_head.load(std::memory_order_relaxed);
+		auto& slot = m_slots[index & kMask];
+
+		slot.sequence.store(notReadable(index), std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		std::array<uint32_t, kWords> words = {};
+		std::memcpy(words.data(), &value, sizeof(T));
+
+		for (size_t n = 0; n < kWords; n++)
+			slot.words[n].store(words[n], std::memory_order_relaxed);
+
+		slot.sequence.store(index, std::memory_order_release);
+		m_head.store(index + 1, std::memory_order_release);
+	}
+
+	class Subscriber
+	{
+	public:
+		// Only samples published after construction are delivered.
+		explicit Subscriber(const TelemetryChannel& channel)
+			: m_channel(channel)
+			, m_cursor(channel.m_head.load(std::memory_order_acquire))
+		{
+		}
+
+		// Calls fn for every sample published since the previous call, oldest first.
+		template<typename F>
+		size_t drain(F&& fn)
+		{
+			const auto head = m_channel.m_head.load(std::memory_order_acquire);
+
+			if (head - m_cursor > Capacity)
+			{
+				m_dropped += head - m_cursor - Capacity;
+				m_cursor = head - Capacity;
+			}
+
+			size_t delivered = 0;
+
+			for (; m_cursor != head; ++m_cursor)
+			{
+				T value;
+
+				if (! m_channel.read(m_cursor, value))
+				{
+					++m_dropped;
+					continue;
+				}
+
+				fn(value);
+				++delivered;
+			}
+
+			return delivered;
+		}
+
+		// Consumes everything pending and returns only the newest sample, if there was one.
+		bool latest(T& value)
+		{
+			return drain([&value](const T& sample) { value = sample; }) > 0;
+		}
+
+		size_t dropped() const
+		{
+			return m_dropped;
+		}
+
+	private:
+		const TelemetryChannel& m_channel;
+		uint32_t m_cursor;
+		size_t m_dropped = 0;
+	};
+
+private:
+	static constexpr size_t kMask = Capacity - 1;
+	static constexpr size_t kWords = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+	// Sequence of a slot that is empty or being written. A slot is only ever read at indices
+	// congruent to its position, and this one isn't, so unlike a fixed marker it can't be
+	// mistaken for a real index once the 32-bit indices wrap.
+	static constexpr uint32_t notReadable(uint32_t index)
+	{
+		return index + 1;
+	}
+
+	struct Slot
+	{
+		std::atomic<uint32_t> sequence;
+		std::array<std::atomic<uint32_t>, kWords> words;
+	};
+
+	// False if the slot was overwritten before or while it was being read.
+	bool read(uint32_t index, T& value) const
+	{
+		const auto& slot = m_slots[index & kMask];
+
+		if (slot.sequence.load(std::memory_order_acquire) != index)
+			return false;
+
+		std::array<uint32_t, kWords> words;
+
+		for (size_t n = 0; n < kWords; n++)
+			words[n] = slot.words[n].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (slot.sequence.load(std::memory_order_relaxed) != index)
+			return false;
+
+		std::memcpy(&value, words.data(), sizeof(T));
+
+		return true;
+	}
+
+	std::array<Slot, Capacity> m_slots;
+	std::atomic<uint32_t> m_head = 0;
+};
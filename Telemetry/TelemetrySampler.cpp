@@ -0,0 +1,97 @@
+#include "TelemetrySampler.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+}
+
+TelemetrySampler::TelemetrySampler(TelemetryBus& bus, uint32_t periodMs)
+	: m_periodMs(periodMs)
+	, m_temperature(bus.boilerCurrentTemp)
+	, m_pressure(bus.boilerPressure)
+	, m_weight(bus.scalesWeight)
+	, m_state(bus.boilerState)
+{
+	m_thread = std::thread(&TelemetrySampler::samplerTask, this);
+}
+
+TelemetrySampler::~TelemetrySampler()
+{
+	{
+		std::lock_guard lock(m_stopMutex);
+		m_stop = true;
+	}
+
+	m_stopCondition.notify_one();
+	m_thread.join();
+}
+
+TelemetrySampler::Stats TelemetrySampler::getStats() const
+{
+	Stats stats;
+
+	for (size_t n = 0; n < m_lateness.size(); n++)
+		stats.lateness[n] = m_lateness[n].load(std::memory_order_relaxed);
+
+	stats.ticksMissed = m_ticksMissed.load(std::memory_order_relaxed);
+	stats.freshTemperature = m_freshTemperature.load(std::memory_order_relaxed);
+	stats.freshPressure = m_freshPressure.load(std::memory_order_relaxed);
+	stats.freshWeight = m_freshWeight.load(std::memory_order_relaxed);
+
+	return stats;
+}
+
+uint32_t TelemetrySampler::nowMs()
+{
+	return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now().time_since_epoch()).count());
+}
+
+void TelemetrySampler::samplerTask()
+{
+	const auto period = std::chrono::milliseconds(m_periodMs);
+
+	TelemetrySample sample { 0, 0.0f, 0.0f, -999.9f, BoilerState::Heating };
+	auto deadline = Clock::now();
+
+	std::unique_lock lock(m_stopMutex);
+
+	while (! m_stop)
+	{
+		const auto now = Clock::now();
+
+		const auto late = std::max(Clock::duration::zero(), now - deadline);
+		const auto lateMs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(late).count());
+		const auto bucket = std::upper_bound(kLatenessBucketsMs.begin(), kLatenessBucketsMs.end(), lateMs) - kLatenessBucketsMs.begin();
+		m_lateness[bucket].fetch_add(1, std::memory_order_relaxed);
+
+		sample.timeMs = nowMs();
+		if (m_temperature.latest(sample.temperature))
+			m_freshTemperature.fetch_add(1, std::memory_order_relaxed);
+
+		if (m_pressure.latest(sample.pressure))
+			m_freshPressure.fetch_add(1, std::memory_order_relaxed);
+
+		if (m_weight.latest(sample.weight))
+			m_freshWeight.fetch_add(1, std::memory_order_relaxed);
+
+		m_state.latest(sample.state);
+
+		samples.publish(sample);
+
+		// Deadlines advance by whole periods so the rate doesn't drift, but after a stall longer
+		// than a period the missed ticks are dropped instead of sampled in a burst
+		deadline += period;
+
+		if (now - deadline >= period)
+		{
+			const auto missed = (now - deadline) / period;
+			m_ticksMissed.fetch_add(static_cast<uint32_t>(missed), std::memory_order_relaxed);
+			deadline += missed * period;
+		}
+
+		m_stopCondition.wait_until(lock, deadline, [this] { return m_stop; });
+	}
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "TelemetryBus.hpp"
+
+struct TelemetrySample
+{
+	uint32_t timeMs;	// Monotonic clock, see TelemetrySampler::nowMs()
+	float temperature;
+	float pressure;
+	float weight;		// -999.9 without scales
+	BoilerState state;
+};
+
+// Samples boiler temperature, pressure and state and the scales' weight at a fixed rate on its
+// own thread, so the sample rate no longer depends on how often LVGL gets to run. Each sample
+// holds the newest reading the controllers have reported and the monotonic time it was taken,
+// consumers derive elapsed time from the timestamps rather than by counting samples.
+//
+// The controllers only push readings through their delegates, there is nothing to poll, so a
+// tick between two reports repeats the previous value. The effective resolution of each channel
+// is capped by how often its controller reports, not by the sample period. The fresh counts in
+// Stats show how many ticks actually picked up a new reading.
+//
+// Every sample is published on samples. The UI appends all of them to its TelemetryStore and can
+// stall for kChannelCapacity samples without losing data.
+class TelemetrySampler
+{
+public:
+	static constexpr uint32_t kDefaultPeriodMs = 20;
+
+	// About five seconds at the default rate
+	static constexpr size_t kChannelCapacity = 256;
+
+	using SampleChannel = TelemetryChannel<TelemetrySample, kChannelCapacity>;
+
+	// Bucket n counts ticks that ran less than kLatenessBucketsMs[n] after their deadline, the
+	// final bucket everything later.
+	static constexpr std::array<uint32_t, 7> kLatenessBucketsMs = { 1, 2, 5, 10, 20, 50, 100 };
+
+	struct Stats
+	{
+		std::array<uint32_t, kLatenessBucketsMs.size() + 1> lateness;
+		uint32_t ticksMissed;	// Skipped when a stall lasted longer than a whole period
+
+		// Ticks that found a new reading on each channel since the last tick
+		uint32_t freshTemperature;
+		uint32_t freshPressure;
+		uint32_t freshWeight;
+	};
+
+	explicit TelemetrySampler(TelemetryBus& bus, uint32_t periodMs = kDefaultPeriodMs);
+	~TelemetrySampler();
+
+	TelemetrySampler(const TelemetrySampler&) = delete;
+	TelemetrySampler& operator=(const TelemetrySampler&) = delete;
+
+	uint32_t periodMs() const
+	{
+		return m_periodMs;
+	}
+
+	Stats getStats() const;
+
+	// Milliseconds on the clock samples are stamped with. Wraps after 49 days, so only compare
+	// timestamps by subtracting them.
+	static uint32_t nowMs();
+
+	SampleChannel samples;
+
+private:
+	void samplerTask();
+
+	uint32_t m_periodMs;
+
+	// Only read from samplerTask()
+	TelemetryBus::FloatChannel::Subscriber m_temperature;
+	TelemetryBus::FloatChannel::Subscriber m_pressure;
+	TelemetryBus::FloatChannel::Subscriber m_weight;
+	TelemetryBus::StateChannel::Subscriber m_state;
+
+	std::array<std::atomic<uint32_t>, kLatenessBucketsMs.size() + 1> m_lateness = {};
+	std::atomic<uint32_t> m_ticksMissed = 0;
+	std::atomic<uint32_t> m_freshTemperature = 0;
+	std::atomic<uint32_t> m_freshPressure = 0;
+	std::atomic<uint32_t> m_freshWeight = 0;
+
+	std::mutex m_stopMutex;
+	std::condition_variable m_stopCondition;
+	bool m_stop = false;
+	std::thread m_thread;
+};
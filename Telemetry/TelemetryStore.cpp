@@ -0,0 +1,103 @@
+#include "TelemetryStore.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+	// Rounds value * scale to the nearest T, saturating at T's limits
+	template<typename T>
+	T quantise(float value, float scale)
+	{
+		const float scaled = std::round(value * scale);
+
+		if (! (scaled > std::numeric_limits<T>::min()))
+			return std::numeric_limits<T>::min();
+
+		if (scaled >= std::numeric_limits<T>::max())
+			return std::numeric_limits<T>::max();
+
+		return static_cast<T>(scaled);
+	}
+}
+
+uint32_t TelemetryStore::push(const TelemetrySample& sample)
+{
+	const uint32_t index = m_head;
+	const size_t slot = index & kMask;
+
+	m_timeMs[slot] = sample.timeMs;
+	m_temperature[slot] = quantise<int16_t>(sample.temperature, 100.0f);
+	m_pressure[slot] = quantise<uint16_t>(sample.pressure, 1000.0f);
+	m_weight[slot] = sample.weight == -999.9f ? kNoWeight : std::max<int16_t>(kNoWeight + 1, quantise<int16_t>(sample.weight, 10.0f));
+	m_state[slot] = static_cast<uint8_t>(sample.state);
+
+	// Weight change over the window, from whatever part of it the store already holds
+	const uint32_t window = static_cast<uint32_t>(std::min(kFlowWindow, m_size));
+	const size_t from = (index - window) & kMask;
+	const uint32_t elapsedMs = sample.timeMs - m_timeMs[from];
+
+	int16_t flow = 0;
+
+	if (window > 0 && elapsedMs > 0 && m_weight[slot] != kNoWeight && m_weight[from] != kNoWeight)
+		flow = quantise<int16_t>((m_weight[slot] - m_weight[from]) * 10000.0f / elapsedMs, 1.0f);	// 0.1 g per ms to 0.01 g/s
+
+	m_flow[slot] = flow;
+
+	++m_head;
+	m_size = std::min(m_size + 1, kCapacity);
+
+	return index;
+}
+
+TelemetryStore::Record TelemetryStore::record(uint32_t index) const
+{
+	const size_t slot = index & kMask;
+
+	return {
+		m_timeMs[slot],
+		m_temperature[slot],
+		m_pressure[slot],
+		m_weight[slot],
+		m_flow[slot],
+		m_state[slot],
+	};
+}
+
+TelemetryStore::Summary TelemetryStore::summarise(uint32_t first, uint32_t end) const
+{
+	Summary summary {};
+
+	summary.samples = end - first;
+
+	if (summary.samples == 0)
+		return summary;
+
+	const uint32_t last = end - 1;
+
+	summary.durationMs = timeMs(last) - timeMs(first);
+
+	// Only the columns the statistics need are read
+	int32_t temperatureSum = 0;
+	uint16_t peakPressure = 0;
+	int16_t peakFlow = 0;
+
+	for (uint32_t index = first; index != end; ++index)
+	{
+		const size_t slot = index & kMask;
+
+		temperatureSum += m_temperature[slot];
+		peakPressure = std::max(peakPressure, m_pressure[slot]);
+		peakFlow = std::max(peakFlow, m_flow[slot]);
+	}
+
+	summary.meanTemperature = temperatureSum / 100.0f / summary.samples;
+	summary.peakPressure = peakPressure / 1000.0f;
+	summary.peakFlow = peakFlow / 100.0f;
+
+	if (hasWeight(first) && hasWeight(last))
+		summary.weightGain = weight(last) - weight(first);
+
+	return summary;
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "TelemetrySampler.hpp"
+
+// Every sample the UI has received, kept as one array per channel in the fixed point units the
+// shot log uses. A sample costs 13 bytes, and a consumer that scans one channel, such as the plot
+// or a statistic, only walks that channel's memory.
+//
+// The chart, the shot logger and shot statistics read the samples they need by index instead of
+// each keeping a copy. Indices count every sample ever pushed and wrap like the channel cursors,
+// the newest kCapacity are kept.
+//
+// Single threaded: written and read on the LVGL thread.
+class TelemetryStore
+{
+public:
+	// About 40 seconds at the 20 ms sample period
+	static constexpr size_t kCapacity = 2048;
+
+	static constexpr uint8_t kTemperatureDecimals = 2;	// 0.01 °C
+	static constexpr uint8_t kPressureDecimals = 3;		// mbar
+	static constexpr uint8_t kWeightDecimals = 1;		// 0.1 g
+	static constexpr uint8_t kFlowDecimals = 2;			// 0.01 g/s
+
+	// Weight the scales report when none are connected, -999.9 g
+	static constexpr int16_t kNoWeight = -9999;
+
+	// Flow is the weight change across this many samples
+	static constexpr size_t kFlowWindow = 25;
+
+	// One sample in store units, for consumers that need a copy such as the log writer
+	struct Record
+	{
+		uint32_t timeMs;
+		int16_t temperature;
+		uint16_t pressure;
+		int16_t weight;
+		int16_t flow;
+		uint8_t state;
+	};
+
+	struct Summary
+	{
+		size_t samples;
+		uint32_t durationMs;
+		float meanTemperature;
+		float peakPressure;
+		float weightGain;	// 0 unless both ends have a weight
+		float peakFlow;
+	};
+
+	TelemetryStore() = default;
+
+	TelemetryStore(const TelemetryStore&) = delete;
+	TelemetryStore& operator=(const TelemetryStore&) = delete;
+
+	// Returns the index of the new sample.
+	uint32_t push(const TelemetrySample& sample);
+
+	// Index the next sample will get; the newest is head() - 1.
+	uint32_t head() const			{ return m_head; }
+
+	// Index of the oldest sample kept.
+	uint32_t first() const			{ return m_head - size(); }
+
+	size_t size() const				{ return m_size; }
+
+	bool contains(uint32_t index) const
+	{
+		return m_head - index - 1 < size();
+	}
+
+	uint32_t timeMs(uint32_t index) const		{ return m_timeMs[index & kMask]; }
+	float temperature(uint32_t index) const		{ return m_temperature[index & kMask] / 100.0f; }
+	float pressure(uint32_t index) const		{ return m_pressure[index & kMask] / 1000.0f; }
+	float flow(uint32_t index) const			{ return m_flow[index & kMask] / 100.0f; }
+	BoilerState state(uint32_t index) const		{ return static_cast<BoilerState>(m_state[index & kMask]); }
+
+	bool hasWeight(uint32_t index) const		{ return m_weight[index & kMask] != kNoWeight; }
+	float weight(uint32_t index) const			{ return m_weight[index & kMask] / 10.0f; }
+
+	Record record(uint32_t index) const;
+
+	// Over the samples from first up to, not including, end. Both must be in the store.
+	Summary summarise(uint32_t first, uint32_t end) const;
+
+private:
+	static_assert((kCapacity & (kCapacity - 1)) == 0, "Capacity must be a power of two");
+	static_assert(kFlowWindow < kCapacity, "Flow window must fit in the store");
+
+	static constexpr size_t kMask = kCapacity - 1;
+
+	std::array<uint32_t, kCapacity> m_timeMs;
+	std::array<int16_t, kCapacity> m_temperature;
+	std::array<uint16_t, kCapacity> m_pressure;
+	std::array<int16_t, kCapacity> m_weight;
+	std::array<int16_t, kCapacity> m_flow;
+	std::array<uint8_t, kCapacity> m_state;
+
+	uint32_t m_head = 0;
+	size_t m_size = 0;
+};
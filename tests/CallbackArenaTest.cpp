@@ -0,0 +1,91 @@
+#include "CallbackArena.hpp"
+#include "TestCheck.hpp"
+
+#include <cstdint>
+
+namespace
+{
+	struct Small
+	{
+		uint8_t value;
+	};
+
+	struct Wide
+	{
+		double value;
+		const char* name;
+	};
+
+	struct alignas(16) Aligned
+	{
+		uint32_t words[4];
+	};
+
+	bool is_aligned(const void* p, size_t alignment)
+	{
+		return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+	}
+
+	void test_alignment_and_values()
+	{
+		CallbackArena<128> arena;
+
+		auto* small = arena.make<Small>(uint8_t(7));
+		auto* wide = arena.make<Wide>(2.5, "wide");
+		auto* small2 = arena.make<Small>(uint8_t(9));
+		auto* aligned = arena.make<Aligned>();
+
+		CHECK(small != nullptr && wide != nullptr && small2 != nullptr && aligned != nullptr);
+
+		CHECK(is_aligned(wide, alignof(Wide)));
+		CHECK(is_aligned(aligned, alignof(Aligned)));
+
+		// Padding goes before a context, never over the previous one
+		CHECK(reinterpret_cast<uint8_t*>(wide) >= reinterpret_cast<uint8_t*>(small) + sizeof(Small));
+		CHECK(reinterpret_cast<uint8_t*>(aligned) >= reinterpret_cast<uint8_t*>(small2) + sizeof(Small));
+
+		CHECK(small->value == 7);
+		CHECK(wide->value == 2.5);
+		CHECK(small2->value == 9);
+
+		// Value initialised
+		for (auto word: aligned->words)
+			CHECK(word == 0);
+
+		CHECK(arena.used() == 48);
+	}
+
+	void test_exhaustion()
+	{
+		CallbackArena<32> arena;
+
+		CHECK(arena.make<Wide>(1.0, "a") != nullptr);
+		CHECK(arena.make<Wide>(2.0, "b") != nullptr);
+		CHECK(arena.used() == 32);
+
+		// Full, and a failed make leaves the arena as it was
+		CHECK(arena.make<Small>(uint8_t(1)) == nullptr);
+		CHECK(arena.used() == 32);
+	}
+
+	void test_alignment_padding_exhausts()
+	{
+		CallbackArena<24> arena;
+
+		CHECK(arena.make<Small>(uint8_t(1)) != nullptr);
+
+		// 8 bytes of padding plus 16 fits exactly, a second one doesn't fit at all
+		CHECK(arena.make<Wide>(1.0, "a") != nullptr);
+		CHECK(arena.used() == 24);
+		CHECK(arena.make<Small>(uint8_t(2)) == nullptr);
+	}
+}
+
+int main()
+{
+	test_alignment_and_values();
+	test_exhaustion();
+	test_alignment_padding_exhausts();
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include "FixedPointFormat.hpp"
+#include "TestCheck.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <random>
+
+// formatFixedPoint() must match snprintf("%.Nf") for every reading the UI shows.
+
+namespace
+{
+	size_t s_compared = 0;
+
+	void check_matches_printf(float value, int decimals)
+	{
+		char expected[64];
+		std::snprintf(expected, sizeof(expected), "%.*f", decimals, value);
+
+		char actual[64];
+		const auto length = formatFixedPoint(actual, sizeof(actual), value, decimals);
+
+		if (std::strcmp(expected, actual) != 0)
+		{
+			std::fprintf(stderr, "%.9g at %d decimals: expected \"%s\", got \"%s\"\n", value, decimals, expected, actual);
+			CHECK(false);
+		}
+
+		CHECK(length == std::strlen(expected));
+		++s_compared;
+	}
+
+	// Every value a step apart across the range, plus the floats either side of each rounding
+	// boundary, where a half way value rounds to even
+	void sweep(float min, float max, int decimals)
+	{
+		const double step = 1.0 / FixedPointDetail::kPow10[decimals];
+		const auto steps = static_cast<int64_t>((max - min) / step);
+
+		for (int64_t n = 0; n <= steps; n++)
+		{
+			const auto value = static_cast<float>(min + n * step);
+			const auto boundary = static_cast<float>(min + (n + 0.5) * step);
+
+			check_matches_printf(value, decimals);
+			check_matches_printf(boundary, decimals);
+			check_matches_printf(std::nextafter(boundary, -INFINITY), decimals);
+			check_matches_printf(std::nextafter(boundary, INFINITY), decimals);
+		}
+	}
+
+	void test_channel_ranges()
+	{
+		for (int decimals = 0; decimals <= kMaxFixedPointDecimals; decimals++)
+		{
+			sweep(-20.0f, 160.0f, decimals);	// Temperature, °C
+			sweep(-1.0f, 16.0f, decimals);		// Pressure, bar
+			sweep(-1000.0f, 1000.0f, decimals);	// Weight, g, including -999.9 without scales
+		}
+	}
+
+	void test_random_floats()
+	{
+		std::mt19937 random(42);
+		std::uniform_real_distribution<float> magnitude(-7.0f, 7.0f);
+
+		for (int n = 0; n < 1000000; n++)
+		{
+			const float value = std::pow(10.0f, magnitude(random)) * (random() & 1 ? -1.0f : 1.0f);
+			check_matches_printf(value, random() % (kMaxFixedPointDecimals + 1));
+		}
+	}
+
+	void test_small_negatives()
+	{
+		// printf keeps the sign of values that round to zero
+		for (int decimals = 0; decimals <= kMaxFixedPointDecimals; decimals++)
+		{
+			check_matches_printf(-0.0f, decimals);
+			check_matches_printf(-0.0004f, decimals);
+			check_matches_printf(-0.04f, decimals);
+			check_matches_printf(-0.5f, decimals);
+			check_matches_printf(0.5f, decimals);
+			check_matches_printf(1.5f, decimals);
+			check_matches_printf(2.5f, decimals);
+			check_matches_printf(0.125f, decimals);
+			check_matches_printf(0.375f, decimals);
+		}
+	}
+
+	void test_invalid_and_truncated()
+	{
+		char out[16];
+
+		CHECK(formatFixedPoint(out, sizeof(out), std::numeric_limits<float>::quiet_NaN(), 1, " bar") == 7);
+		CHECK(std::strcmp(out, "--- bar") == 0);
+
+		formatFixedPoint(out, sizeof(out), std::numeric_limits<float>::infinity(), 1);
+		CHECK(std::strcmp(out, "---") == 0);
+
+		formatFixedPoint(out, sizeof(out), 1e20f, 1);
+		CHECK(std::strcmp(out, "---") == 0);
+
+		CHECK(formatFixedPoint(out, 6, 93.25f, 2, "°c") == 5);
+		CHECK(std::strcmp(out, "93.25") == 0);
+
+		CHECK(formatFixedPoint(out, 1, 93.25f, 2) == 0);
+		CHECK(out[0] == '\0');
+	}
+}
+
+int main()
+{
+	test_small_negatives();
+	test_channel_ranges();
+	test_random_floats();
+	test_invalid_and_truncated();
+
+	std::printf("%zu values match snprintf\n", s_compared);
+
+	return 0;
+}
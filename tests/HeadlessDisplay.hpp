@@ -0,0 +1,68 @@
+#pragma once
+
+#include "lvgl.h"
+
+#include "EspressoLayout.hpp"
+
+#include <chrono>
+
+// A display for the LVGL host tests, drawn into a buffer nobody looks at. Rendering still does
+// all the work it does on the device, only the flush to a panel is missing.
+//
+// Included by one test each, the helpers are inline so a test needn't use all of them.
+
+namespace
+{
+	constexpr lv_coord_t kWidth = ESPRESSO_UI_DISPLAY_WIDTH;
+	constexpr lv_coord_t kHeight = EspressoLayout::get().height;
+
+	inline void flush_cb(lv_disp_drv_t* drv, const lv_area_t*, lv_color_t*)
+	{
+		lv_disp_flush_ready(drv);
+	}
+
+	inline void init_display()
+	{
+		static lv_color_t buffer[kWidth * 40];
+		static lv_disp_draw_buf_t drawBuffer;
+		static lv_disp_drv_t driver;
+
+		lv_init();
+
+		lv_disp_draw_buf_init(&drawBuffer, buffer, nullptr, kWidth * 40);
+
+		lv_disp_drv_init(&driver);
+		driver.hor_res = kWidth;
+		driver.ver_res = kHeight;
+		driver.flush_cb = flush_cb;
+		driver.draw_buf = &drawBuffer;
+		lv_disp_drv_register(&driver);
+	}
+
+	// Long enough for the tabs' timers to fire and the screen to be drawn
+	inline void run_frames(int count)
+	{
+		for (int n = 0; n < count; n++)
+		{
+			lv_tick_inc(10);
+			lv_timer_handler();
+		}
+	}
+
+	inline size_t used_memory()
+	{
+		lv_mem_monitor_t monitor;
+		lv_mem_monitor(&monitor);
+
+		return monitor.total_size - monitor.free_size;
+	}
+
+	// Draws whatever is invalid now and returns how long it took
+	inline double render_ms()
+	{
+		const auto start = std::chrono::steady_clock::now();
+		lv_refr_now(nullptr);
+
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
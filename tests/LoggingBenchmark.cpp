@@ -0,0 +1,207 @@
+#include "Logging.hpp"
+#include "TestCheck.hpp"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+// Times each Logging::AddData() call in the background mode: with the store not yet full, with
+// the store wrapping, and with the writer stalled so blocks and segments run out. The old logger
+// appended to a std::vector, which is timed the same way for comparison.
+//
+// The writer is stalled by making its first log file a FIFO, opening it blocks until the
+// benchmark starts reading.
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr uint16_t kSamplePeriodMs = 20;
+	constexpr size_t kSamples = 20000;
+
+	// Shots end this often, so the stalled writer also runs out of segments
+	constexpr size_t kShotSamples = 300;
+
+	using Clock = std::chrono::steady_clock;
+
+	struct Timing
+	{
+		double meanNs = 0.0;
+		double p99Ns = 0.0;
+		double maxNs = 0.0;
+	};
+
+	TelemetrySample make_sample(uint32_t n)
+	{
+		return { n * kSamplePeriodMs, 90.0f + (n % 50) * 0.1f, (n % 90) * 0.1f, n * 0.1f, BoilerState::Brewing };
+	}
+
+	// prepare(n) runs untimed before each timed fn(n)
+	template<typename Prepare, typename Fn>
+	Timing time_calls(size_t count, Prepare&& prepare, Fn&& fn)
+	{
+		std::vector<double> ns(count);
+
+		for (size_t n = 0; n < count; n++)
+		{
+			prepare(n);
+
+			const auto start = Clock::now();
+			fn(n);
+			ns[n] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		}
+
+		Timing timing;
+
+		for (double t: ns)
+			timing.meanNs += t / count;
+
+		std::sort(ns.begin(), ns.end());
+		timing.p99Ns = ns[count * 99 / 100];
+		timing.maxNs = ns.back();
+
+		return timing;
+	}
+
+	void print(const char* name, const Timing& timing, const Logging::Stats* stats = nullptr)
+	{
+		std::printf("%-18s mean %6.1f ns, p99 %6.1f ns, max %9.1f ns", name, timing.meanNs, timing.p99Ns, timing.maxNs);
+
+		if (stats != nullptr)
+			std::printf(", %zu delayed, %zu dropped", stats->samplesDelayed, stats->samplesDropped);
+
+		std::printf("\n");
+	}
+
+	// The file name Logging picks for its first log when constructed now
+	std::string first_log_path(const std::string& suffix)
+	{
+		const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+
+		std::stringstream name;
+		name << "logs/" << std::put_time(std::localtime(&now), "%Y-%m-%d_%H-%M-%S_") << suffix << "1.esl";
+
+		return name.str();
+	}
+
+	void bench_vector()
+	{
+		auto store = std::make_unique<TelemetryStore>();
+		std::vector<TelemetryStore::Record> shot;
+		uint32_t index = 0;
+
+		const auto timing = time_calls(kSamples,
+			[&](size_t n) { index = store->push(make_sample(n)); },
+			[&](size_t) { shot.push_back(store->record(index)); });
+
+		print("std::vector (old)", timing);
+	}
+
+	// Only AddData() is timed, pushing to the store is the sampler's cost
+	void bench_store(const char* name, size_t prefill, size_t count)
+	{
+		auto store = std::make_unique<TelemetryStore>();
+		uint32_t time = 0;
+		uint32_t index = 0;
+
+		for (size_t n = 0; n < prefill; n++)
+			store->push(make_sample(time++));
+
+		Logging logger(*store, false, "bench", Logging::WriteMode::Background, Logging::FileFormat::Binary, kSamplePeriodMs);
+
+		// The samples come far faster than the sampler's period here, waiting for the writer
+		// between flushes stands in for one that keeps up
+		const auto timing = time_calls(count,
+			[&](size_t n) {
+				if (n % Logging::kFlushThreshold == 0)
+					logger.Drain();
+
+				index = store->push(make_sample(time++));
+			},
+			[&](size_t) { logger.AddData(index); });
+
+		logger.Drain();
+		const auto stats = logger.GetStats();
+		CHECK(stats.samplesDropped == 0);
+
+		print(name, timing, &stats);
+	}
+
+	void bench_stalled_writer()
+	{
+		auto store = std::make_unique<TelemetryStore>();
+		std::unique_ptr<Logging> logger;
+		std::string fifo;
+
+		// The name has a one second resolution, retry if it ticked over during construction
+		do
+		{
+			logger.reset();
+			fifo = first_log_path("stalled");
+			logger = std::make_unique<Logging>(*store, false, "stalled", Logging::WriteMode::Background, Logging::FileFormat::Binary, kSamplePeriodMs);
+		}
+		while (fifo != first_log_path("stalled"));
+
+		CHECK(mkfifo(fifo.c_str(), 0600) == 0);
+
+		uint32_t time = 0;
+		uint32_t index = 0;
+
+		const auto timing = time_calls(kSamples,
+			[&](size_t) { index = store->push(make_sample(time++)); },
+			[&](size_t n) {
+				logger->AddData(index);
+
+				if ((n + 1) % kShotSamples == 0)
+					logger->FlushLog(true);
+			});
+
+		const auto stats = logger->GetStats();
+		print("stalled writer", timing, &stats);
+
+		// Everything past the blocks and segments is lost, but nothing waited for the writer
+		CHECK(stats.samplesDropped > 0);
+
+		// Unblock the writer, it closes the FIFO when its first log ends
+		std::FILE* reader = std::fopen(fifo.c_str(), "rb");
+		CHECK(reader != nullptr);
+
+		char buffer[4096];
+		while (std::fread(buffer, 1, sizeof(buffer), reader) > 0)
+		{
+		}
+
+		std::fclose(reader);
+
+		logger->Drain();
+		logger.reset();
+	}
+}
+
+int main()
+{
+	const auto scratch = fs::current_path() / "LoggingBenchmark.logs";
+
+	fs::remove_all(scratch);
+	fs::create_directories(scratch);
+	fs::current_path(scratch);
+
+	std::printf("Per AddData() call, timer overhead included\n");
+
+	bench_vector();
+	bench_store("store not full", 0, TelemetryStore::kCapacity);
+	bench_store("store wrapping", 3 * TelemetryStore::kCapacity, kSamples);
+	bench_stalled_writer();
+
+	fs::current_path(scratch.parent_path());
+	fs::remove_all(scratch);
+
+	return 0;
+}
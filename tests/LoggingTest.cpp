@@ -0,0 +1,138 @@
+#include "Logging.hpp"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+
+// Writes shot logs in the background mode into a scratch directory and reads them back.
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr uint16_t kSamplePeriodMs = 20;
+
+	struct Shot
+	{
+		size_t samples;
+		size_t gapBefore;	// Samples pushed to the store but not logged, e.g. between shots
+	};
+
+	TelemetrySample make_sample(uint32_t n)
+	{
+		return { n * kSamplePeriodMs, 90.0f + (n % 50) * 0.1f, (n % 90) * 0.1f, n * 0.1f, BoilerState::Brewing };
+	}
+
+	// Sample counts of every log written, in log order
+	std::vector<size_t> read_logs(const std::string& suffix)
+	{
+		std::vector<std::string> paths;
+
+		for (const auto& entry: fs::directory_iterator("logs"))
+		{
+			if (entry.path().filename().string().find(suffix) != std::string::npos)
+				paths.push_back(entry.path().string());
+		}
+
+		// Numbered from 1, sort 10 after 9
+		std::sort(paths.begin(), paths.end(), [](const auto& a, const auto& b) {
+			return a.size() != b.size() ? a.size() < b.size() : a < b;
+		});
+
+		std::vector<size_t> counts;
+
+		for (const auto& path: paths)
+		{
+			ShotLogReader reader(path);
+			CHECK(reader.isValid());
+
+			uint32_t timeMs;
+			ShotLogFormat::Sample sample;
+			size_t count = 0;
+
+			while (reader.next(timeMs, sample))
+				++count;
+
+			counts.push_back(count);
+		}
+
+		return counts;
+	}
+
+	// Logs each shot back to back without waiting for the writer, as EspressoBrewTab does
+	void run(const std::string& suffix, const std::vector<Shot>& shots)
+	{
+		auto store = std::make_unique<TelemetryStore>();
+		uint32_t time = 0;
+
+		{
+			Logging logger(*store, false, suffix, Logging::WriteMode::Background, Logging::FileFormat::Binary, kSamplePeriodMs);
+
+			for (const auto& shot: shots)
+			{
+				for (size_t n = 0; n < shot.gapBefore; n++)
+					store->push(make_sample(time++));
+
+				for (size_t n = 0; n < shot.samples; n++)
+					logger.AddData(store->push(make_sample(time++)));
+
+				logger.FlushLog(true);
+			}
+
+			logger.Drain();
+
+			const auto stats = logger.GetStats();
+			CHECK(stats.samplesDropped == 0);
+		}
+
+		// Shots without samples don't get a file
+		std::vector<size_t> expected;
+
+		for (const auto& shot: shots)
+		{
+			if (shot.samples > 0)
+				expected.push_back(shot.samples);
+		}
+
+		CHECK(read_logs(suffix) == expected);
+	}
+
+	// The first log still has samples queued when the following ones end, each must keep its own
+	// file
+	void test_log_ends_while_writer_behind()
+	{
+		run("behind", { { 1500, 0 }, { 10, 0 }, { 5, 0 }, { 300, 0 } });
+	}
+
+	void test_logs_with_gaps()
+	{
+		run("gaps", { { 1200, 0 }, { 40, 100 }, { 130, 3 }, { 1, 50 } });
+	}
+
+	// Ending a log twice in a row, before and after the writer has the first end
+	void test_log_ended_twice()
+	{
+		run("twice", { { 0, 0 }, { 700, 0 }, { 0, 0 }, { 0, 10 }, { 20, 0 }, { 0, 0 } });
+	}
+}
+
+int main()
+{
+	const auto scratch = fs::current_path() / "LoggingTest.logs";
+
+	fs::remove_all(scratch);
+	fs::create_directories(scratch);
+	fs::current_path(scratch);
+
+	for (int n = 0; n < 20; n++)
+	{
+		fs::remove_all("logs");
+
+		test_log_ends_while_writer_behind();
+		test_logs_with_gaps();
+		test_log_ended_twice();
+	}
+
+	return 0;
+}
@@ -0,0 +1,536 @@
+#include "lvgl.h"
+
+#include "EspressoBrewTab.hpp"
+#include "EspressoGauge.hpp"
+#include "EspressoImageDecoder.hpp"
+#include "EspressoLayout.hpp"
+#include "EspressoLivePlot.hpp"
+#include "EspressoSettingsTab.hpp"
+#include "EspressoTheme.hpp"
+#include "EspressoUI.hpp"
+#include "HeadlessDisplay.hpp"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+// Times rendering on a headless display, comparing the UI's widgets, styles and image decoding
+// with what they replaced. Only the draw is timed, the changes that invalidate each frame are made
+// first. The last cases time building the UI: the brew tab's build steps, each tab's redraw in
+// this build's layout profile, and EspressoUI from init() to its first frame.
+
+// The logo as the UI has it, run-length encoded by tools/compress_image.py, and the image
+// converter's output it was compressed from
+LV_IMG_DECLARE(espresso_logo);
+LV_IMG_DECLARE(espresso_logo_raw);
+
+namespace
+{
+	constexpr int kFrames = 200;
+
+	// A minute of plot points at the brew tab's 100 ms period, which fills the plot's width and
+	// makes it switch to a coarser level
+	constexpr int kPlotFrames = 600;
+
+	constexpr auto kBrew = EspressoLayout::get().brew;
+
+	struct Timing
+	{
+		double meanMs = 0.0;
+		double maxMs = 0.0;
+	};
+
+	// update(n) makes the nth frame's changes
+	template<typename Fn>
+	Timing time_frames(int count, Fn&& update)
+	{
+		Timing timing;
+
+		for (int n = 0; n < count; n++)
+		{
+			update(n);
+
+			const double ms = render_ms();
+			timing.meanMs += ms / count;
+			timing.maxMs = std::max(timing.maxMs, ms);
+		}
+
+		return timing;
+	}
+
+	void print(const char* name, const Timing& timing, size_t heapBytes = 0)
+	{
+		std::printf("  %-24s mean %7.3f ms, max %7.3f ms", name, timing.meanMs, timing.maxMs);
+
+		if (heapBytes != 0)
+			std::printf(", %zu bytes of LVGL heap", heapBytes);
+
+		std::printf("\n");
+	}
+
+	lv_obj_t* create_page()
+	{
+		lv_obj_t* page = lv_obj_create(lv_scr_act());
+		lv_obj_set_size(page, kWidth, EspressoLayout::get().pageHeight());
+
+		// Draw the page once so only the frames' own changes are timed
+		render_ms();
+
+		return page;
+	}
+
+	// The temperature gauge's scale, as the brew tab builds it
+	void add_temperature_scale(lv_obj_t* meter)
+	{
+		lv_obj_add_style(meter, EspressoTheme::needlePivot(), LV_PART_INDICATOR);
+		lv_obj_add_style(meter, EspressoTheme::text(EspressoTheme::Text::Scale), 0);
+
+		lv_meter_scale_t* scale = lv_meter_add_scale(meter);
+		lv_meter_set_scale_ticks(meter, scale, 41, 1, 8, lv_palette_main(LV_PALETTE_GREY));
+		lv_meter_set_scale_major_ticks(meter, scale, 8, 2, 8, lv_color_black(), 10);
+		lv_meter_set_scale_range(meter, scale, 0, 200, 270, 135);
+
+		lv_meter_indicator_t* indic = lv_meter_add_arc(meter, scale, 2, lv_palette_main(LV_PALETTE_BLUE), 0);
+		lv_meter_set_indicator_start_value(meter, indic, 0);
+		lv_meter_set_indicator_end_value(meter, indic, 40);
+
+		indic = lv_meter_add_arc(meter, scale, 2, lv_palette_main(LV_PALETTE_RED), 0);
+		lv_meter_set_indicator_start_value(meter, indic, 160);
+		lv_meter_set_indicator_end_value(meter, indic, 200);
+	}
+
+	// The needle sweeps back and forth across the scale, one step per frame
+	int32_t needle_value(int n)
+	{
+		const int step = n % 100;
+		return 2 * (step < 50 ? step : 100 - step) + 50;
+	}
+
+	// A needle moving over the temperature scale, on one lv_meter as before the gauges were
+	// cached and on an EspressoGauge
+	void bench_gauge()
+	{
+		std::printf("Needle update, gauge %d px\n", kBrew.gaugeSize);
+
+		{
+			lv_obj_t* page = create_page();
+
+			lv_obj_t* meter = lv_meter_create(page);
+			lv_obj_remove_style(meter, nullptr, LV_PART_MAIN);
+			lv_obj_set_size(meter, kBrew.gaugeSize, kBrew.gaugeSize);
+			add_temperature_scale(meter);
+
+			lv_meter_scale_t* needleScale = lv_meter_add_scale(meter);
+			lv_meter_set_scale_ticks(meter, needleScale, 0, 0, 0, lv_color_black());
+			lv_meter_set_scale_range(meter, needleScale, 0, 200, 270, 135);
+			lv_meter_indicator_t* needle = lv_meter_add_needle_line(meter, needleScale, 2, lv_palette_main(LV_PALETTE_RED), -10);
+
+			render_ms();
+
+			print("lv_meter (old)", time_frames(kFrames, [&](int n) { lv_meter_set_indicator_end_value(meter, needle, needle_value(n)); }));
+
+			lv_obj_del(page);
+		}
+
+		{
+			lv_obj_t* page = create_page();
+
+			EspressoGauge gauge(page, kBrew.gaugeSize);
+			add_temperature_scale(gauge.scaleMeter());
+			lv_obj_add_style(gauge.needleMeter(), EspressoTheme::needlePivot(), LV_PART_INDICATOR);
+
+			lv_meter_scale_t* needleScale = gauge.addNeedleScale(0, 200, 270, 135);
+			lv_meter_indicator_t* needle = lv_meter_add_needle_line(gauge.needleMeter(), needleScale, 2, lv_palette_main(LV_PALETTE_RED), -10);
+
+			gauge.refresh();
+			render_ms();
+
+			print(ESPRESSO_UI_CACHED_GAUGES ? "EspressoGauge" : "EspressoGauge, uncached",
+				time_frames(kFrames, [&](int n) { lv_meter_set_indicator_end_value(gauge.needleMeter(), needle, needle_value(n)); }));
+
+			lv_obj_del(page);
+		}
+	}
+
+	// The brew tab's chart, as buildChart() makes it
+	lv_obj_t* create_chart(lv_obj_t* parent)
+	{
+		lv_obj_t* chart = lv_chart_create(parent);
+		lv_obj_set_size(chart, kBrew.panelWidth, kBrew.chartHeight(EspressoLayout::get().pageGap));
+		lv_obj_center(chart);
+
+		lv_chart_set_axis_tick(chart, LV_CHART_AXIS_PRIMARY_X, 3, 2, 12, 3, true, 40);
+		lv_chart_set_axis_tick(chart, LV_CHART_AXIS_PRIMARY_Y, 3, 2, 6, 2, true, 50);
+
+		lv_obj_add_style(chart, EspressoTheme::text(EspressoTheme::Text::Axis), 0);
+
+		return chart;
+	}
+
+	// Temperature wobbling a few degrees above 93 and pressure ramping up to 9 bar, times 20 as
+	// the brew tab plots it
+	lv_coord_t plot_temperature(int n)
+	{
+		return static_cast<lv_coord_t>(93 + (n % 40 < 20 ? n % 40 : 40 - n % 40) / 4);
+	}
+
+	lv_coord_t plot_pressure(int n)
+	{
+		return static_cast<lv_coord_t>(std::min(n, 180));
+	}
+
+	// A new point per frame for both of the brew tab's series, on a stock lv_chart as before the
+	// live plot and on an EspressoLivePlot over the same chart
+	void bench_plot()
+	{
+		std::printf("Plot point, chart %d x %d px, %d points\n", kBrew.panelWidth, kBrew.chartHeight(EspressoLayout::get().pageGap), kPlotFrames);
+
+		{
+			lv_obj_t* page = create_page();
+			const size_t before = used_memory();
+
+			lv_obj_t* chart = create_chart(page);
+			lv_chart_set_point_count(chart, kBrew.plotPoints);
+			lv_chart_set_range(chart, LV_CHART_AXIS_PRIMARY_Y, 50, 150);
+			lv_chart_set_range(chart, LV_CHART_AXIS_SECONDARY_Y, 0, 14 * 20);
+
+			lv_chart_series_t* temperature = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y);
+			lv_chart_series_t* pressure = lv_chart_add_series(chart, lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_SECONDARY_Y);
+
+			render_ms();
+			const size_t heap = used_memory() - before;
+
+			print("lv_chart (old)", time_frames(kPlotFrames, [&](int n) {
+				lv_chart_set_next_value(chart, temperature, plot_temperature(n));
+				lv_chart_set_next_value(chart, pressure, plot_pressure(n));
+			}), heap);
+
+			lv_obj_del(page);
+		}
+
+		{
+			lv_obj_t* page = create_page();
+			const size_t before = used_memory();
+
+			EspressoLivePlot plot(create_chart(page), kBrew.plotPoints);
+			plot.addSeries(lv_palette_main(LV_PALETTE_RED), LV_CHART_AXIS_PRIMARY_Y, 50, 150);
+			plot.addSeries(lv_palette_main(LV_PALETTE_BLUE), LV_CHART_AXIS_SECONDARY_Y, 0, 14 * 20);
+
+			render_ms();
+			const size_t heap = used_memory() - before;
+
+			print("EspressoLivePlot", time_frames(kPlotFrames, [&](int n) {
+				plot.push({plot_temperature(n), plot_pressure(n)});
+			}), heap);
+
+			lv_obj_del(page);
+		}
+	}
+
+	// The settings tab's groups of labels and sliders, styled either with EspressoTheme's shared
+	// styles or with the same values set as local properties on every object, as before the theme
+	// had them
+	void build_settings(lv_obj_t* page, const lv_font_t* font, bool shared)
+	{
+		constexpr auto kSettings = EspressoLayout::get().settings;
+
+		lv_obj_set_flex_flow(page, LV_FLEX_FLOW_COLUMN);
+
+		const auto style_text = [&](lv_obj_t* label) {
+			if (shared)
+				lv_obj_add_style(label, EspressoTheme::text(EspressoTheme::Text::Body), 0);
+			else
+				lv_obj_set_style_text_font(label, font, 0);
+		};
+
+		for (int rows: EspressoLayout::kSettingsRows)
+		{
+			lv_obj_t* group = lv_obj_create(page);
+			lv_obj_set_size(group, kSettings.groupWidth, kSettings.groupHeight(rows));
+			lv_obj_set_flex_flow(group, LV_FLEX_FLOW_ROW_WRAP);
+			lv_obj_clear_flag(group, LV_OBJ_FLAG_SCROLLABLE);
+
+			if (shared)
+			{
+				lv_obj_add_style(group, EspressoTheme::settingsGroup(), 0);
+			}
+			else
+			{
+				lv_obj_set_style_pad_all(group, kSettings.groupPad, 0);
+				lv_obj_set_style_pad_row(group, kSettings.rowGap, 0);
+				lv_obj_set_style_pad_column(group, kSettings.columnGap, 0);
+				lv_obj_set_style_border_width(group, EspressoLayout::kPanelBorder, 0);
+			}
+
+			for (int row = 0; row < rows; row++)
+			{
+				lv_obj_t* label = lv_label_create(group);
+				lv_label_set_text(label, "Setting");
+				style_text(label);
+
+				lv_obj_t* slider = lv_slider_create(group);
+				lv_obj_set_size(slider, kSettings.sliderWidth, kSettings.sliderHeight);
+
+				lv_obj_t* value = lv_label_create(slider);
+				lv_label_set_text(value, "93°c");
+				lv_obj_center(value);
+				style_text(value);
+			}
+		}
+	}
+
+	// Heap taken by the settings tab's objects and the time to redraw all of them, which
+	// resolves every style property they draw with
+	void bench_styles()
+	{
+		std::printf("Settings groups, full redraw\n");
+
+		// The font the shared Body style sets
+		lv_obj_t* probe = lv_label_create(lv_scr_act());
+		lv_obj_add_style(probe, EspressoTheme::text(EspressoTheme::Text::Body), 0);
+		const lv_font_t* font = lv_obj_get_style_text_font(probe, 0);
+		lv_obj_del(probe);
+
+		for (bool shared: {false, true})
+		{
+			lv_obj_t* page = create_page();
+			const size_t before = used_memory();
+
+			build_settings(page, font, shared);
+
+			render_ms();
+			const size_t heap = used_memory() - before;
+
+			print(shared ? "shared styles" : "local properties (old)", time_frames(kFrames, [&](int) { lv_obj_invalidate(page); }), heap);
+
+			lv_obj_del(page);
+		}
+	}
+
+	// The logo drawn straight from the uncompressed image, as before compression, and from the
+	// compressed one with and without its decode in EspressoImageDecoder's cache
+	void bench_logo()
+	{
+		std::printf("Logo draw, %d x %d px\n", int(espresso_logo.header.w), int(espresso_logo.header.h));
+
+		lv_obj_t* page = create_page();
+		lv_obj_t* logo = lv_img_create(page);
+		lv_obj_center(logo);
+
+		lv_img_set_src(logo, &espresso_logo_raw);
+		render_ms();
+
+		print("uncompressed (old)", time_frames(kFrames, [&](int) { lv_obj_invalidate(logo); }));
+
+		lv_img_set_src(logo, &espresso_logo);
+		render_ms();
+
+		// LVGL's own image cache would keep the decoder's image open
+		print("compressed, cold", time_frames(kFrames, [&](int) {
+			lv_img_cache_invalidate_src(&espresso_logo);
+			EspressoImageDecoder::dropCache();
+			lv_obj_invalidate(logo);
+		}));
+
+		print("compressed, warm", time_frames(kFrames, [&](int) { lv_obj_invalidate(logo); }));
+
+		lv_obj_del(page);
+	}
+
+	double elapsed_ms(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// The brew tab's build steps one at a time, as EspressoUI runs them in slices while the
+	// connection screen animates. Before the steps the whole tab was built within one frame.
+	void bench_build_steps(BoilerController* boiler, ScalesController* scales)
+	{
+		std::printf("Brew tab build\n");
+
+		lv_obj_t* page = create_page();
+		double total = 0.0;
+		double longest = 0.0;
+
+		{
+			auto start = std::chrono::steady_clock::now();
+			EspressoBrewTab tab(page, boiler, scales);
+			total = elapsed_ms(start);
+
+			std::printf("  %-24s %7.3f ms\n", "constructor", total);
+
+			for (int step = 0; ; step++)
+			{
+				start = std::chrono::steady_clock::now();
+				const bool built = tab.buildStep();
+				const double ms = elapsed_ms(start);
+
+				std::printf("  step %-19d %7.3f ms\n", step, ms);
+
+				total += ms;
+				longest = std::max(longest, ms);
+
+				if (built)
+					break;
+			}
+		}
+
+		lv_obj_del(page);
+
+		std::printf("  whole tab (old) %.3f ms, longest step %.3f ms\n", total, longest);
+	}
+
+	// Objects that would scroll, their content doesn't fit inside them
+	uint32_t count_overflowing(lv_obj_t* obj)
+	{
+		uint32_t count = 0;
+
+		if (lv_obj_has_flag(obj, LV_OBJ_FLAG_SCROLLABLE) && (lv_obj_get_scroll_bottom(obj) > 0 || lv_obj_get_scroll_right(obj) > 0))
+			++count;
+
+		for (uint32_t n = 0; n < lv_obj_get_child_cnt(obj); n++)
+			count += count_overflowing(lv_obj_get_child(obj, n));
+
+		return count;
+	}
+
+	// A full redraw of each tab in this build's layout profile, which must fit its page without
+	// anything scrolling
+	void bench_tabs(BoilerController* boiler, ScalesController* scales)
+	{
+		std::printf("Tab redraw, %d x %d profile\n", kWidth, kHeight);
+
+		const auto bench_tab = [](const char* name, lv_obj_t* page, size_t heap) {
+			const uint32_t overflowing = count_overflowing(page);
+
+			if (overflowing != 0)
+				std::fprintf(stderr, "%s: %u objects overflow\n", name, unsigned(overflowing));
+
+			CHECK(overflowing == 0);
+
+			print(name, time_frames(kFrames, [&](int) { lv_obj_invalidate(page); }), heap);
+		};
+
+		// The tabs clean their page when destroyed, the page goes after them
+		lv_obj_t* page = create_page();
+
+		{
+			const size_t before = used_memory();
+
+			EspressoBrewTab tab(page, boiler, scales);
+
+			while (! tab.buildStep())
+			{
+			}
+
+			lv_obj_update_layout(page);
+			render_ms();
+			bench_tab("Brew tab", page, used_memory() - before);
+		}
+
+		{
+			const size_t before = used_memory();
+
+			EspressoSettingsTab tab(page);
+
+			lv_obj_update_layout(page);
+			render_ms();
+			bench_tab("Settings tab", page, used_memory() - before);
+		}
+
+		lv_obj_del(page);
+	}
+
+	uint32_t count_objects(lv_obj_t* obj)
+	{
+		uint32_t count = 1;
+
+		for (uint32_t n = 0; n < lv_obj_get_child_cnt(obj); n++)
+			count += count_objects(lv_obj_get_child(obj, n));
+
+		return count;
+	}
+
+	struct Boot
+	{
+		double firstFrameMs;
+		uint32_t objects;
+		size_t heapBytes;
+		uint32_t peakObjects;
+	};
+
+	// EspressoUI from init() until its first frame is drawn, optionally building the settings tab
+	// before that frame as the UI did before the tab was built on first use
+	Boot boot(BoilerController* boiler, ScalesController* scales, bool eager)
+	{
+		Boot result;
+
+		{
+			const size_t before = used_memory();
+			const auto start = std::chrono::steady_clock::now();
+
+			EspressoUI ui;
+			ui.init(boiler, scales);
+
+			if (eager)
+				ui.buildSettingsTab();
+
+			render_ms();
+
+			result.firstFrameMs = elapsed_ms(start);
+			result.objects = count_objects(lv_scr_act());
+			result.heapBytes = used_memory() - before;
+
+			// Whichever way it boots, the UI ends up with both tabs
+			ui.buildSettingsTab();
+			result.peakObjects = count_objects(lv_scr_act());
+		}
+
+		// The UI leaves its screen behind
+		lv_scr_load_anim(lv_obj_create(nullptr), LV_SCR_LOAD_ANIM_NONE, 0, 0, true);
+
+		return result;
+	}
+
+	void bench_boot(BoilerController* boiler, ScalesController* scales)
+	{
+		std::printf("Boot to first frame\n");
+
+		// The first boot also fills caches that live as long as the UI
+		boot(boiler, scales, false);
+
+		for (bool eager: {true, false})
+		{
+			const auto result = boot(boiler, scales, eager);
+
+			std::printf("  %-24s %7.1f ms, %u objects, %zu bytes of LVGL heap, %u objects with both tabs\n",
+				eager ? "both tabs (old)" : "settings tab deferred", result.firstFrameMs, unsigned(result.objects),
+				result.heapBytes, unsigned(result.peakObjects));
+		}
+	}
+}
+
+int main()
+{
+	init_display();
+	EspressoTheme::init();
+	EspressoImageDecoder::init();
+	SettingsManager::get().loadDefaults(false);
+
+	BoilerController boiler;
+	ScalesController scales;
+
+	bench_gauge();
+	bench_plot();
+	bench_styles();
+	bench_logo();
+	bench_build_steps(&boiler, &scales);
+	bench_tabs(&boiler, &scales);
+
+	CHECK(lv_obj_get_child_cnt(lv_scr_act()) == 0);
+
+	bench_boot(&boiler, &scales);
+
+	return 0;
+}
@@ -0,0 +1,115 @@
+#include "SettingsManager.hpp"
+#include "TestCheck.hpp"
+
+#include <vector>
+
+namespace
+{
+	struct Recorder : public SettingsBatchDelegate
+	{
+		void onSettingsChanged(const SettingMask& changed, const SettingsView&) override
+		{
+			++calls;
+			lastChanged = changed;
+
+			for (auto* other: unsubscribeOnCall)
+				SettingsManager::get().unsubscribe(other);
+		}
+
+		int calls = 0;
+		SettingMask lastChanged;
+		std::vector<SettingsBatchDelegate*> unsubscribeOnCall;
+	};
+
+	void change_brew_temp()
+	{
+		auto& settings = SettingsManager::get();
+		settings[SettingId::BrewTemp] = settings[SettingId::BrewTemp].getAs<float>() + 0.5f;
+	}
+
+	void test_changes_are_batched()
+	{
+		auto& settings = SettingsManager::get();
+		Recorder recorder;
+
+		settings.subscribe(&recorder, { SettingId::BrewTemp, SettingId::SteamTemp });
+
+		settings[SettingId::BrewTemp] = 94.0f;
+		settings[SettingId::BrewTemp] = 95.0f;
+		settings[SettingId::PumpKp] = 2.0f;
+		settings.dispatchChanges();
+
+		CHECK(recorder.calls == 1);
+		CHECK(recorder.lastChanged.count() == 1);
+		CHECK(recorder.lastChanged.test(static_cast<size_t>(SettingId::BrewTemp)));
+
+		// Nothing changed since
+		settings.dispatchChanges();
+		CHECK(recorder.calls == 1);
+
+		settings.unsubscribe(&recorder);
+	}
+
+	void test_unsubscribe_self_during_dispatch()
+	{
+		auto& settings = SettingsManager::get();
+		Recorder first, second, third;
+
+		first.unsubscribeOnCall = { &first };
+
+		settings.subscribe(&first, { SettingId::BrewTemp });
+		settings.subscribe(&second, { SettingId::BrewTemp });
+		settings.subscribe(&third, { SettingId::BrewTemp });
+
+		change_brew_temp();
+		settings.dispatchChanges();
+
+		CHECK(first.calls == 1);
+		CHECK(second.calls == 1);
+		CHECK(third.calls == 1);
+
+		change_brew_temp();
+		settings.dispatchChanges();
+
+		CHECK(first.calls == 1);
+		CHECK(second.calls == 2);
+		CHECK(third.calls == 2);
+
+		settings.unsubscribe(&second);
+		settings.unsubscribe(&third);
+	}
+
+	void test_unsubscribe_other_during_dispatch()
+	{
+		auto& settings = SettingsManager::get();
+		Recorder first, second, third;
+
+		first.unsubscribeOnCall = { &second };
+
+		settings.subscribe(&first, { SettingId::BrewTemp });
+		settings.subscribe(&second, { SettingId::BrewTemp });
+		settings.subscribe(&third, { SettingId::BrewTemp });
+
+		change_brew_temp();
+		settings.dispatchChanges();
+
+		CHECK(first.calls == 1);
+		CHECK(second.calls == 0);
+		CHECK(third.calls == 1);
+
+		settings.unsubscribe(&first);
+		settings.unsubscribe(&third);
+	}
+}
+
+int main()
+{
+	SettingsManager::get().loadDefaults(false);
+	SettingsManager::get().dispatchChanges();
+
+	test_changes_are_batched();
+	test_unsubscribe_self_during_dispatch();
+	test_unsubscribe_other_during_dispatch();
+
+	return 0;
+}
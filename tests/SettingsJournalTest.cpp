@@ -0,0 +1,215 @@
+#include "SettingsStorage.hpp"
+#include "TestCheck.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+// Runs the journal backend against Settings.journal in the working directory.
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr auto kJournalPath = "Settings.journal";
+
+	std::vector<uint8_t> read_journal()
+	{
+		std::ifstream journal(kJournalPath, std::ios::binary);
+		return { std::istreambuf_iterator<char>(journal), std::istreambuf_iterator<char>() };
+	}
+
+	void write_journal(const std::vector<uint8_t>& data, size_t length)
+	{
+		std::ofstream journal(kJournalPath, std::ios::binary | std::ios::trunc);
+		journal.write(reinterpret_cast<const char*>(data.data()), length);
+	}
+
+	// Number of records in the journal, every byte of it must parse
+	size_t count_records()
+	{
+		const auto data = read_journal();
+
+		size_t count = 0;
+		size_t pos = 0;
+		std::string key;
+		Setting::SettingValue value;
+
+		while (pos < data.size())
+		{
+			const auto length = parseSettingRecord(data.data() + pos, data.size() - pos, key, value);
+			CHECK(length != 0);
+
+			pos += length;
+			++count;
+		}
+
+		return count;
+	}
+
+	float brew_temp()
+	{
+		return SettingsManager::get()[SettingId::BrewTemp].getAs<float>();
+	}
+
+	float steam_temp()
+	{
+		return SettingsManager::get()[SettingId::SteamTemp].getAs<float>();
+	}
+
+	void test_truncated_last_record()
+	{
+		auto& settings = SettingsManager::get();
+
+		fs::remove(kJournalPath);
+		settings.load();
+
+		// Defaults, one record per key
+		CHECK(count_records() == kSettingCount);
+
+		settings[SettingId::BrewTemp] = 94.0f;
+		settings.save();
+
+		const auto lastRecordStart = read_journal().size();
+
+		settings[SettingId::SteamTemp] = 140.0f;
+		settings.save();
+
+		const auto full = read_journal();
+		CHECK(full.size() > lastRecordStart);
+
+		// Every cut through the last record loses only that record
+		for (size_t length = lastRecordStart + 1; length < full.size(); length++)
+		{
+			write_journal(full, length);
+			settings.load();
+
+			CHECK(brew_temp() == 94.0f);
+			CHECK(steam_temp() == 145.0f);
+
+			// The damaged tail was compacted away, leaving one valid record per key
+			CHECK(count_records() == kSettingCount);
+
+			// And the journal keeps working after compaction
+			settings[SettingId::SteamTemp] = 141.0f;
+			settings.save();
+			settings.load();
+
+			CHECK(brew_temp() == 94.0f);
+			CHECK(steam_temp() == 141.0f);
+			CHECK(count_records() == kSettingCount + 1);
+
+			settings[SettingId::SteamTemp] = 145.0f;
+		}
+
+		write_journal(full, full.size());
+		settings.load();
+
+		CHECK(brew_temp() == 94.0f);
+		CHECK(steam_temp() == 140.0f);
+	}
+
+	void test_compaction()
+	{
+		auto& settings = SettingsManager::get();
+
+		fs::remove(kJournalPath);
+		settings.load();
+
+		size_t largest = 0;
+
+		for (int n = 0; n < 1000; n++)
+		{
+			settings[SettingId::BrewTemp] = 85.0f + (n % 100) * 0.1f;
+			settings.save();
+
+			largest = std::max<size_t>(largest, read_journal().size());
+		}
+
+		// Compaction kept the journal from growing with every write
+		CHECK(largest < 8192);
+
+		const auto expected = brew_temp();
+		settings.load();
+
+		CHECK(brew_temp() == expected);
+	}
+
+	void test_long_key_rejected()
+	{
+		auto& settings = SettingsManager::get();
+
+		fs::remove(kJournalPath);
+		settings.load();
+
+		const std::string longKey(kMaxSettingKeyLength + 45, 'k');
+		const std::string maxKey(kMaxSettingKeyLength, 'm');
+
+		settings[longKey] = 1.0f;
+		settings[maxKey] = 2.0f;
+		settings[SettingId::BrewTemp] = 96.0f;
+		settings.save();
+
+		// A truncated length byte would have left a record that fails to parse
+		CHECK(count_records() == kSettingCount + 2);
+
+		settings.load();
+
+		CHECK(brew_temp() == 96.0f);
+		CHECK(settings[maxKey].getAs<float>() == 2.0f);
+
+		std::vector<uint8_t> records;
+		CHECK(! appendSettingRecord(records, longKey, 1.0f));
+		CHECK(records.empty());
+
+		// Snapshots skip the key too and stay valid
+		const auto snapshot = encodeSettingsSnapshot({ { longKey, 1.0f }, { "BrewTemp", 97.0f } });
+		CHECK(decodeSettingsSnapshot(snapshot.data(), snapshot.size(), settings));
+		CHECK(brew_temp() == 97.0f);
+	}
+
+	// Records of schema settings with another type, e.g. from an older build or a damaged file
+	void test_wrong_type_records()
+	{
+		auto& settings = SettingsManager::get();
+
+		fs::remove(kJournalPath);
+		settings.load();
+
+		auto data = read_journal();
+		CHECK(appendSettingRecord(data, "BrewTemp", int64_t(92)));
+		CHECK(appendSettingRecord(data, "SteamTemp", std::string("hot")));
+		CHECK(appendSettingRecord(data, "HotWaterModeEnabled", 1.0f));
+		CHECK(appendSettingRecord(data, "ManualPumpControlEnabled", int64_t(0)));
+		CHECK(appendSettingRecord(data, "BrewPressure", true));
+		write_journal(data, data.size());
+
+		settings.load();
+
+		// Numbers are converted to the schema's type, the string is dropped for the default
+		CHECK(settings.value<SettingId::BrewTemp>() == 92.0f);
+		CHECK(settings.value<SettingId::SteamTemp>() == schemaFor(SettingId::SteamTemp).defaultValue);
+		CHECK(settings.value<SettingId::HotWaterModeEnabled>());
+		CHECK(! settings.value<SettingId::ManualPumpControlEnabled>());
+		CHECK(settings.value<SettingId::BrewPressure>() == 1.0f);
+		CHECK(settings.read<SettingId::BrewTemp>() == 92.0f);
+
+		// Snapshots go through the same conversion
+		const auto snapshot = encodeSettingsSnapshot({ { "BrewTemp", std::string("x") }, { "SteamTemp", int64_t(140) } });
+		CHECK(decodeSettingsSnapshot(snapshot.data(), snapshot.size(), settings));
+		CHECK(settings.value<SettingId::BrewTemp>() == 92.0f);
+		CHECK(settings.value<SettingId::SteamTemp>() == 140.0f);
+	}
+}
+
+int main()
+{
+	test_truncated_last_record();
+	test_compaction();
+	test_long_key_rejected();
+	test_wrong_type_records();
+
+	fs::remove(kJournalPath);
+
+	return 0;
+}
@@ -0,0 +1,99 @@
+#include "SettingsStorage.hpp"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <thread>
+
+// Drives requestSave() the way a dragged slider does, against the journal backend.
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	using namespace std::chrono_literals;
+	using Clock = std::chrono::steady_clock;
+
+	constexpr auto kQuietPeriod = 50ms;
+	constexpr int kRequests = 500;
+
+	void wait_for_writes(size_t count)
+	{
+		const auto deadline = Clock::now() + 5s;
+
+		while (SettingsManager::get().getPersistenceStats().savesWritten < count)
+		{
+			CHECK(Clock::now() < deadline);
+			std::this_thread::sleep_for(5ms);
+		}
+	}
+
+	void test_requests_are_coalesced()
+	{
+		auto& settings = SettingsManager::get();
+
+		fs::remove("Settings.journal");
+		settings.load();
+		settings.setSaveQuietPeriod(kQuietPeriod);
+
+		settings["ExtraKey"] = std::string("kept");
+
+		const auto writes = settings.getPersistenceStats().savesWritten;
+		const auto start = Clock::now();
+
+		for (int n = 0; n < kRequests; n++)
+		{
+			settings[SettingId::BrewTemp] = 85.0f + n * 0.01f;
+			settings[SettingId::HotWaterModeEnabled] = n % 2 == 0;
+			settings.requestSave();
+		}
+
+		const auto requestTime = Clock::now() - start;
+
+		wait_for_writes(writes + 1);
+		std::this_thread::sleep_for(kQuietPeriod * 2);
+
+		CHECK(settings.getPersistenceStats().savesWritten == writes + 1);
+
+		std::printf("%d requests, %.2f us each on the calling thread\n",
+			kRequests, std::chrono::duration<double, std::micro>(requestTime).count() / kRequests);
+
+		// The write saw the final values, schema and extra keys alike
+		settings[SettingId::BrewTemp] = 90.0f;
+		settings[SettingId::HotWaterModeEnabled] = true;
+		settings.load();
+
+		CHECK(settings[SettingId::BrewTemp].getAs<float>() == 85.0f + (kRequests - 1) * 0.01f);
+		CHECK(! settings[SettingId::HotWaterModeEnabled].getAs<bool>());
+		CHECK(settings["ExtraKey"].getAs<std::string>() == "kept");
+	}
+
+	void test_flush_writes_pending()
+	{
+		auto& settings = SettingsManager::get();
+
+		settings.setSaveQuietPeriod(10s);
+
+		const auto writes = settings.getPersistenceStats().savesWritten;
+
+		settings[SettingId::SteamTemp] = 130.0f;
+		settings.requestSave();
+		settings.flush();
+
+		CHECK(settings.getPersistenceStats().savesWritten == writes + 1);
+
+		settings.load();
+		CHECK(settings[SettingId::SteamTemp].getAs<float>() == 130.0f);
+	}
+}
+
+int main()
+{
+	test_requests_are_coalesced();
+	test_flush_writes_pending();
+
+	fs::remove("Settings.journal");
+
+	return 0;
+}
@@ -0,0 +1,88 @@
+#include "SettingsView.hpp"
+#include "TestCheck.hpp"
+
+#include <atomic>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr int kReaders = 4;
+	constexpr int kPublishes = 200000;
+
+	// Every value in a batch is set to the same number, so any mix of two batches shows up as
+	// a snapshot whose values differ
+	void publish_all(SettingsPublisher& publisher, float value)
+	{
+		SettingsPublisher::Batch batch(publisher);
+
+		for (size_t n = 0; n < kSettingCount; n++)
+			publisher.publish(static_cast<SettingId>(n), value);
+	}
+
+	void test_batches_are_never_torn()
+	{
+		SettingsPublisher publisher;
+		std::atomic<bool> done = false;
+		std::atomic<size_t> snapshots = 0;
+
+		std::vector<std::thread> readers;
+
+		for (int n = 0; n < kReaders; n++)
+		{
+			readers.emplace_back([&] {
+				float last = 0.0f;
+				size_t count = 0;
+
+				while (! done.load(std::memory_order_relaxed))
+				{
+					const auto view = publisher.snapshot();
+
+					for (float value: view.values)
+						CHECK(value == view.values[0]);
+
+					// Publishes only ever count up
+					CHECK(view.values[0] >= last);
+					last = view.values[0];
+
+					++count;
+				}
+
+				snapshots += count;
+			});
+		}
+
+		for (int n = 1; n <= kPublishes; n++)
+			publish_all(publisher, static_cast<float>(n));
+
+		done = true;
+
+		for (auto& reader: readers)
+			reader.join();
+
+		CHECK(publisher.snapshot().values[0] == static_cast<float>(kPublishes));
+
+		std::printf("%d publishes, %zu snapshots across %d readers\n", kPublishes, snapshots.load(), kReaders);
+	}
+
+	void test_single_publish()
+	{
+		SettingsPublisher publisher;
+
+		publisher.publish(SettingId::BrewTemp, 93.5f);
+		publisher.publish(SettingId::HotWaterModeEnabled, 1.0f);
+
+		CHECK(publisher.get<SettingId::BrewTemp>() == 93.5f);
+		CHECK(publisher.get<SettingId::HotWaterModeEnabled>());
+		CHECK(! publisher.get<SettingId::ManualPumpControlEnabled>());
+	}
+}
+
+int main()
+{
+	test_single_publish();
+	test_batches_are_never_torn();
+
+	return 0;
+}
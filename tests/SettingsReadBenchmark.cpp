@@ -0,0 +1,166 @@
+#include "SettingsManager.hpp"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Times the controller threads' reads, readSnapshot() and read<Id>(), against the mutex guarded
+// std::unordered_map<std::string, Setting> they used to read, first alone and then with another
+// thread writing settings as fast as it can.
+//
+// The mean comes from an untimed loop. The tail comes from timing each call, which adds the
+// clock's own overhead, and shows how long a reader can be held up by the writer.
+
+namespace
+{
+	constexpr int kIterations = 500000;
+
+	using Clock = std::chrono::steady_clock;
+
+	struct Timing
+	{
+		double meanNs;
+		double p999Ns;
+		double maxNs;
+	};
+
+	template<typename Fn>
+	Timing time_reads(Fn&& fn)
+	{
+		Timing timing;
+
+		auto start = Clock::now();
+
+		for (int n = 0; n < kIterations; n++)
+			fn();
+
+		timing.meanNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kIterations;
+
+		std::vector<double> ns(kIterations);
+
+		for (auto& t: ns)
+		{
+			start = Clock::now();
+			fn();
+			t = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+		}
+
+		std::sort(ns.begin(), ns.end());
+		timing.p999Ns = ns[kIterations * 999 / 1000];
+		timing.maxNs = ns.back();
+
+		return timing;
+	}
+
+	// The settings as they were before the publisher
+	struct LockedMap
+	{
+		std::mutex mutex;
+		std::unordered_map<std::string, Setting> settings;
+
+		float read(const char* key)
+		{
+			std::lock_guard lock(mutex);
+			return settings[key].getAs<float>();
+		}
+
+		SettingsView snapshot()
+		{
+			std::lock_guard lock(mutex);
+			SettingsView view;
+
+			for (const auto& entry: kSettingsSchema)
+			{
+				const auto value = settings[std::string(entry.name)].get();
+				view.values[static_cast<size_t>(entry.id)] = entry.type == SettingType::Bool ? std::get<bool>(value) : std::get<float>(value);
+			}
+
+			return view;
+		}
+
+		void write(const char* key, float value)
+		{
+			std::lock_guard lock(mutex);
+			settings[key] = value;
+		}
+	};
+
+	// Runs write(n) on another thread until the returned object goes out of scope
+	class Writer
+	{
+	public:
+		template<typename Fn>
+		explicit Writer(Fn&& write)
+			: m_thread([this, write] {
+				for (int n = 0; ! m_stop.load(std::memory_order_relaxed); n++)
+					write(n);
+			})
+		{
+		}
+
+		~Writer()
+		{
+			m_stop = true;
+			m_thread.join();
+		}
+
+	private:
+		std::atomic<bool> m_stop = false;
+		std::thread m_thread;
+	};
+
+	void print(const char* name, const Timing& timing)
+	{
+		std::printf("  %-16s mean %6.1f ns, p99.9 %8.1f ns, max %10.1f ns\n", name, timing.meanNs, timing.p999Ns, timing.maxNs);
+	}
+}
+
+int main()
+{
+	auto& settings = SettingsManager::get();
+	settings.loadDefaults(false);
+
+	LockedMap map;
+
+	for (const auto& entry: kSettingsSchema)
+	{
+		if (entry.type == SettingType::Bool)
+			map.settings[std::string(entry.name)] = entry.defaultValue != 0.0f;
+		else
+			map.settings[std::string(entry.name)] = entry.defaultValue;
+	}
+
+	volatile float sink = 0.0f;
+
+	const auto run = [&] {
+		print("map read", time_reads([&] { sink = map.read("BrewTemp"); }));
+		print("read<Id>()", time_reads([&] { sink = settings.read<SettingId::BrewTemp>(); }));
+		print("map snapshot", time_reads([&] { sink = map.snapshot().values[0]; }));
+		print("readSnapshot()", time_reads([&] { sink = settings.readSnapshot().values[0]; }));
+	};
+
+	std::printf("Readers alone\n");
+	run();
+
+	// The writer updates the setting the readers read, in the map and in the manager
+	std::printf("With a writer\n");
+	{
+		Writer writer([&](int n) {
+			map.write("BrewTemp", 85.0f + n % 100 * 0.1f);
+			settings[SettingId::BrewTemp] = 85.0f + n % 100 * 0.1f;
+		});
+
+		run();
+	}
+
+	CHECK(settings.read<SettingId::BrewTemp>() == settings.value<SettingId::BrewTemp>());
+
+	return 0;
+}
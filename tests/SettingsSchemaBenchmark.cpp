@@ -0,0 +1,70 @@
+#include "SettingsManager.hpp"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+
+// Times reading and writing schema settings through SettingsManager, indexed by SettingId and
+// looked up by name, against the std::unordered_map<std::string, Setting> keyed by string
+// literals that the settings lived in before the schema.
+
+namespace
+{
+	constexpr int kIterations = 1000000;
+
+	using Clock = std::chrono::steady_clock;
+
+	template<typename Fn>
+	double ns_per_call(Fn&& fn)
+	{
+		const auto start = Clock::now();
+
+		for (int n = 0; n < kIterations; n++)
+			fn(n);
+
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kIterations;
+	}
+
+	// The names as the UI code spelled them, one std::string built per access
+	const char* name_of(int n)
+	{
+		return kSettingsSchema[n % kSettingCount].name.data();
+	}
+
+	SettingId id_of(int n)
+	{
+		return static_cast<SettingId>(n % kSettingCount);
+	}
+}
+
+int main()
+{
+	auto& settings = SettingsManager::get();
+	settings.loadDefaults(false);
+
+	std::unordered_map<std::string, Setting> map;
+
+	for (const auto& entry: kSettingsSchema)
+		map[std::string(entry.name)] = entry.defaultValue;
+
+	// Only floats, so every access reads the same variant alternative
+	volatile float sink = 0.0f;
+
+	const double mapRead = ns_per_call([&](int n) { sink = sink + map[name_of(n * 7 % 9)].getAs<float>(); });
+	const double indexRead = ns_per_call([&](int n) { sink = sink + settings[id_of(n * 7 % 9)].getAs<float>(); });
+	const double typedRead = ns_per_call([&](int) { sink = sink + settings.value<SettingId::BrewTemp>(); });
+	const double nameRead = ns_per_call([&](int n) { sink = sink + settings[name_of(n * 7 % 9)].getAs<float>(); });
+
+	const double mapWrite = ns_per_call([&](int n) { map[name_of(n * 7 % 9)] = float(n % 100); });
+	const double indexWrite = ns_per_call([&](int n) { settings[id_of(n * 7 % 9)] = float(n % 100); });
+
+	CHECK(sink != 0.0f);
+
+	std::printf("Per access, the first 9 schema settings in turn\n");
+	std::printf("read:  map %6.1f ns, SettingId %6.1f ns, value<Id>() %6.1f ns, by name %6.1f ns\n", mapRead, indexRead, typedRead, nameRead);
+	std::printf("write: map %6.1f ns, SettingId %6.1f ns (publishes to readers)\n", mapWrite, indexWrite);
+
+	return 0;
+}
@@ -0,0 +1,120 @@
+#include "SettingsStorage.hpp"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+// Times loading a settings snapshot the way SettingsManagerFile does: one read of the file and a
+// decode into the SettingsManager. Run with the schema alone (~12 keys) and with ~1000 extra keys,
+// which is far more than the firmware stores but shows how load time scales.
+
+namespace fs = std::filesystem;
+
+namespace
+{
+	constexpr auto kPath = "SettingsStorageBenchmark.bin";
+	constexpr int kIterations = 200;
+
+	using Clock = std::chrono::steady_clock;
+
+	SettingsManager::Snapshot make_snapshot(size_t extraKeys)
+	{
+		SettingsManager::Snapshot snapshot;
+
+		for (const auto& entry: kSettingsSchema)
+		{
+			if (entry.type == SettingType::Bool)
+				snapshot.emplace_back(std::string(entry.name), entry.defaultValue != 0.0f);
+			else
+				snapshot.emplace_back(std::string(entry.name), entry.defaultValue);
+		}
+
+		for (size_t n = 0; n < extraKeys; n++)
+		{
+			char key[32];
+			std::snprintf(key, sizeof(key), "Extra%04zu", n);
+
+			switch (n % 4)
+			{
+			case 0: snapshot.emplace_back(key, n % 8 == 0); break;
+			case 1: snapshot.emplace_back(key, static_cast<int64_t>(n) * 1000); break;
+			case 2: snapshot.emplace_back(key, static_cast<float>(n) / 7.0f); break;
+			case 3: snapshot.emplace_back(key, std::string("value ") + key); break;
+			}
+		}
+
+		return snapshot;
+	}
+
+	bool load_file(SettingsManager& settings)
+	{
+		std::error_code ec;
+		const auto size = fs::file_size(kPath, ec);
+
+		if (ec)
+			return false;
+
+		std::vector<uint8_t> data(size);
+
+		std::ifstream file(kPath, std::ios::binary);
+		if (! file.read(reinterpret_cast<char*>(data.data()), data.size()))
+			return false;
+
+		return decodeSettingsSnapshot(data.data(), data.size(), settings);
+	}
+
+	void run(size_t extraKeys)
+	{
+		const auto snapshot = make_snapshot(extraKeys);
+
+		const auto encodeStart = Clock::now();
+		std::vector<uint8_t> data;
+
+		for (int n = 0; n < kIterations; n++)
+			data = encodeSettingsSnapshot(snapshot);
+
+		const auto encodeTime = Clock::now() - encodeStart;
+
+		{
+			std::ofstream file(kPath, std::ios::binary | std::ios::trunc);
+			file.write(reinterpret_cast<const char*>(data.data()), data.size());
+		}
+
+		auto& settings = SettingsManager::get();
+
+		const auto loadStart = Clock::now();
+
+		for (int n = 0; n < kIterations; n++)
+			CHECK(load_file(settings));
+
+		const auto loadTime = Clock::now() - loadStart;
+
+		// Everything written is read back
+		for (const auto& [key, value]: snapshot)
+			CHECK(settings[key].get() == value);
+
+		// A corrupt byte fails the checksum before anything is applied
+		data[data.size() / 2] ^= 0x40;
+		CHECK(! decodeSettingsSnapshot(data.data(), data.size(), settings));
+
+		using us = std::chrono::duration<double, std::micro>;
+
+		std::printf("%5zu keys, %6zu bytes: encode %8.1f us, load %8.1f us\n",
+			snapshot.size(),
+			data.size(),
+			us(encodeTime).count() / kIterations,
+			us(loadTime).count() / kIterations);
+
+		fs::remove(kPath);
+	}
+}
+
+int main()
+{
+	run(0);
+	run(1000);
+
+	return 0;
+}
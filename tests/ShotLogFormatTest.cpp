@@ -0,0 +1,260 @@
+#include "ShotLogFormat.hpp"
+#include "TelemetryStore.hpp"
+#include "TestCheck.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <vector>
+
+// Round trips samples through the store and the binary log, checks damaged logs are read safely
+// and compares the binary log's encode time and size with CSV. Leaves ShotLogFormatTest.esl
+// behind for the shotlog_to_csv test.
+
+namespace
+{
+	constexpr uint16_t kSamplePeriodMs = 20;
+	constexpr auto kLogPath = "ShotLogFormatTest.esl";
+
+	constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+	constexpr float kInf = std::numeric_limits<float>::infinity();
+
+	using Clock = std::chrono::steady_clock;
+
+	ShotLogFormat::Sample to_log_sample(const TelemetryStore::Record& record)
+	{
+		return { record.temperature, record.pressure, record.weight, record.flow, record.state };
+	}
+
+	// A 30 second shot: pressure ramps up and holds, weight rises once the puck is saturated
+	std::vector<TelemetrySample> make_shot()
+	{
+		std::vector<TelemetrySample> samples;
+
+		for (uint32_t n = 0; n < 1500; n++)
+		{
+			const float t = n * kSamplePeriodMs / 1000.0f;
+			const float pressure = std::min(9.0f, t * 1.5f) + 0.05f * std::sin(t * 7.0f);
+			const float weight = t < 6.0f ? 0.0f : (t - 6.0f) * 1.6f;
+
+			samples.push_back({ n * kSamplePeriodMs + n % 3, 93.0f - 0.02f * t, pressure, weight, BoilerState::Brewing });
+		}
+
+		return samples;
+	}
+
+	std::vector<uint8_t> encode(const TelemetryStore& store, uint32_t first, uint32_t end)
+	{
+		std::vector<uint8_t> data(ShotLogFormat::kHeaderSize + (end - first) * ShotLogFormat::kMaxSampleSize);
+
+		ShotLogEncoder encoder(kSamplePeriodMs);
+		size_t length = encoder.encodeHeader(data.data());
+
+		for (uint32_t index = first; index != end; index++)
+		{
+			const auto record = store.record(index);
+			length += encoder.encodeSample(record.timeMs, to_log_sample(record), data.data() + length);
+		}
+
+		data.resize(length);
+
+		return data;
+	}
+
+	void write_file(const char* path, const std::vector<uint8_t>& data)
+	{
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+	}
+
+	// Readings that can't be represented are clamped by the store, never wrapped
+	void test_out_of_range_readings()
+	{
+		auto store = std::make_unique<TelemetryStore>();
+
+		const std::vector<TelemetrySample> samples = {
+			{ 0, 93.0f, 9.0f, 10.0f, BoilerState::Brewing },
+			{ 20, kNaN, kNaN, kNaN, BoilerState::Brewing },
+			{ 40, kInf, kInf, kInf, BoilerState::Brewing },
+			{ 60, -kInf, -kInf, -kInf, BoilerState::Brewing },
+			{ 80, 1e9f, 1e9f, 1e9f, BoilerState::Brewing },
+			{ 100, -1e9f, -1e9f, -1e9f, BoilerState::Brewing },
+			{ 120, 93.0f, 9.0f, -999.9f, BoilerState::Idle },
+		};
+
+		for (const auto& sample: samples)
+			store->push(sample);
+
+		write_file(kLogPath, encode(*store, 0, store->head()));
+
+		ShotLogReader reader(kLogPath);
+		CHECK(reader.isValid());
+
+		uint32_t timeMs;
+		ShotLogFormat::Sample sample;
+
+		for (uint32_t index = 0; index < store->head(); index++)
+		{
+			CHECK(reader.next(timeMs, sample));
+
+			const auto expected = to_log_sample(store->record(index));
+			CHECK(sample == expected);
+			CHECK(timeMs == samples[index].timeMs);
+		}
+
+		CHECK(! reader.next(timeMs, sample));
+
+		// Temperature in 0.01 °C, pressure in mbar
+		CHECK(store->record(1).temperature == std::numeric_limits<int16_t>::min());
+		CHECK(store->record(2).temperature == std::numeric_limits<int16_t>::max());
+		CHECK(store->record(3).pressure == 0);
+		CHECK(store->record(4).pressure == std::numeric_limits<uint16_t>::max());
+		CHECK(store->record(6).weight == TelemetryStore::kNoWeight);
+	}
+
+	// Any int32 survives the delta encoding, including steps that overflow a subtraction
+	void test_extreme_values()
+	{
+		const std::vector<ShotLogFormat::Sample> samples = {
+			{ 0, 0, 0, 0, 0 },
+			{ INT32_MAX, INT32_MIN, -1, 1, INT32_MAX },
+			{ INT32_MIN, INT32_MAX, 1, -1, INT32_MIN },
+			{ 0, 0, INT32_MIN, INT32_MAX, 0 },
+		};
+
+		std::vector<uint8_t> data(ShotLogFormat::kHeaderSize + samples.size() * ShotLogFormat::kMaxSampleSize);
+
+		ShotLogEncoder encoder(kSamplePeriodMs);
+		size_t length = encoder.encodeHeader(data.data());
+
+		for (size_t n = 0; n < samples.size(); n++)
+			length += encoder.encodeSample(n * kSamplePeriodMs, samples[n], data.data() + length);
+
+		data.resize(length);
+		write_file(kLogPath, data);
+
+		ShotLogReader reader(kLogPath);
+		uint32_t timeMs;
+		ShotLogFormat::Sample sample;
+
+		for (const auto& expected: samples)
+		{
+			CHECK(reader.next(timeMs, sample));
+			CHECK(sample == expected);
+
+			// Including INT32_MIN
+			std::ostringstream csv;
+			ShotLogFormat::WriteCsvRow(csv, timeMs, sample);
+		}
+
+		CHECK(! reader.next(timeMs, sample));
+	}
+
+	// Damaged logs end early or read garbage, but never run past the file or overflow
+	void test_damaged_logs()
+	{
+		auto store = std::make_unique<TelemetryStore>();
+
+		for (const auto& sample: make_shot())
+			store->push(sample);
+
+		const auto log = encode(*store, store->first(), store->first() + 200);
+
+		std::mt19937 random(1234);
+
+		for (int n = 0; n < 500; n++)
+		{
+			auto damaged = log;
+
+			for (int flips = 0; flips < 8; flips++)
+				damaged[ShotLogFormat::kHeaderSize + random() % (damaged.size() - ShotLogFormat::kHeaderSize)] = static_cast<uint8_t>(random());
+
+			damaged.resize(ShotLogFormat::kHeaderSize + random() % (damaged.size() - ShotLogFormat::kHeaderSize));
+			write_file(kLogPath, damaged);
+
+			ShotLogReader reader(kLogPath);
+			CHECK(reader.isValid());
+
+			uint32_t timeMs;
+			ShotLogFormat::Sample sample;
+			size_t count = 0;
+			std::ostringstream csv;
+
+			while (reader.next(timeMs, sample))
+			{
+				ShotLogFormat::WriteCsvRow(csv, timeMs, sample);
+				++count;
+			}
+
+			CHECK(count <= damaged.size());
+		}
+	}
+
+	void benchmark_against_csv()
+	{
+		auto store = std::make_unique<TelemetryStore>();
+
+		for (const auto& sample: make_shot())
+			store->push(sample);
+
+		const uint32_t first = store->first();
+		const uint32_t end = store->head();
+		const size_t samples = end - first;
+
+		constexpr int kIterations = 50;
+
+		std::vector<uint8_t> binary;
+		const auto binaryStart = Clock::now();
+
+		for (int n = 0; n < kIterations; n++)
+			binary = encode(*store, first, end);
+
+		const auto binaryTime = Clock::now() - binaryStart;
+
+		std::string csv;
+		const auto csvStart = Clock::now();
+
+		for (int n = 0; n < kIterations; n++)
+		{
+			std::ostringstream out;
+			ShotLogFormat::WriteCsvHeader(out);
+
+			for (uint32_t index = first; index != end; index++)
+			{
+				const auto record = store->record(index);
+				ShotLogFormat::WriteCsvRow(out, record.timeMs - store->timeMs(first), to_log_sample(record));
+			}
+
+			csv = out.str();
+		}
+
+		const auto csvTime = Clock::now() - csvStart;
+
+		using ns = std::chrono::duration<double, std::nano>;
+
+		std::printf("%zu samples\n", samples);
+		std::printf("  binary: %7zu bytes, %5.2f bytes/sample, %6.1f ns/sample\n",
+			binary.size(), double(binary.size()) / samples, ns(binaryTime).count() / kIterations / samples);
+		std::printf("  csv:    %7zu bytes, %5.2f bytes/sample, %6.1f ns/sample\n",
+			csv.size(), double(csv.size()) / samples, ns(csvTime).count() / kIterations / samples);
+
+		CHECK(binary.size() < csv.size());
+
+		// Left for the shotlog_to_csv test
+		write_file(kLogPath, binary);
+	}
+}
+
+int main()
+{
+	test_out_of_range_readings();
+	test_extreme_values();
+	test_damaged_logs();
+	benchmark_against_csv();
+
+	return 0;
+}
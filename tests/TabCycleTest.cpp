@@ -0,0 +1,78 @@
+#include "lvgl.h"
+
+#include "EspressoBrewTab.hpp"
+#include "EspressoImageDecoder.hpp"
+#include "EspressoLayout.hpp"
+#include "EspressoSettingsTab.hpp"
+#include "EspressoTheme.hpp"
+#include "HeadlessDisplay.hpp"
+#include "TestCheck.hpp"
+
+#include <cstdio>
+
+// Builds and deletes each tab repeatedly on a headless display and checks LVGL's heap ends every
+// cycle where it ended the first one. The first cycle may leave caches behind that live as long
+// as the UI, such as decoded images; anything after that is a leak.
+
+namespace
+{
+	constexpr int kCycles = 20;
+
+	template<typename F>
+	void check_cycles(const char* name, F&& cycle)
+	{
+		size_t baseline = 0;
+
+		for (int n = 0; n < kCycles; n++)
+		{
+			lv_obj_t* page = lv_obj_create(lv_scr_act());
+			lv_obj_set_size(page, kWidth, EspressoLayout::get().pageHeight());
+
+			cycle(page);
+
+			lv_obj_del(page);
+			run_frames(2);
+
+			const auto used = used_memory();
+
+			if (n == 0)
+				baseline = used;
+
+			if (used != baseline)
+				std::fprintf(stderr, "%s: cycle %d ended with %zu bytes in use, first ended with %zu\n", name, n, used, baseline);
+
+			CHECK(used == baseline);
+		}
+
+		std::printf("%s: %d cycles, %zu bytes in use after each\n", name, kCycles, baseline);
+	}
+}
+
+int main()
+{
+	init_display();
+
+	EspressoTheme::init();
+	EspressoImageDecoder::init();
+	SettingsManager::get().loadDefaults(false);
+
+	BoilerController boiler;
+	ScalesController scales;
+
+	check_cycles("Brew tab", [&](lv_obj_t* page) {
+		EspressoBrewTab tab(page, &boiler, &scales);
+
+		while (! tab.buildStep())
+		{
+		}
+
+		run_frames(20);
+	});
+
+	check_cycles("Settings tab", [&](lv_obj_t* page) {
+		EspressoSettingsTab tab(page);
+		run_frames(20);
+	});
+
+	return 0;
+}
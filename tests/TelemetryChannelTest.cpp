@@ -0,0 +1,191 @@
+#include "TelemetryChannel.hpp"
+#include "TestCheck.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// One producer publishing while subscribers drain on other threads. Every delivered sample must
+// be whole and in order, and every published sample is either delivered or counted as dropped.
+
+namespace
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Wider than a word so a torn read shows as fields that disagree
+	struct Sample
+	{
+		uint32_t sequence;
+		uint32_t inverted;
+		uint64_t squared;
+	};
+
+	constexpr size_t kCapacity = 64;
+	constexpr uint32_t kPublishes = 2000000;
+
+	using Channel = TelemetryChannel<Sample, kCapacity>;
+
+	Sample make_sample(uint32_t sequence)
+	{
+		return { sequence, ~sequence, uint64_t(sequence) * sequence };
+	}
+
+	struct Result
+	{
+		size_t delivered = 0;
+		size_t dropped = 0;
+	};
+
+	// pauseEvery > 0 makes a subscriber that falls behind and overruns
+	Result subscribe(const Channel& channel, const std::atomic<bool>& done, uint32_t pauseEvery)
+	{
+		Channel::Subscriber subscriber(channel);
+		Result result;
+		int64_t last = -1;
+
+		auto check = [&](const Sample& sample) {
+			CHECK(sample.inverted == ~sample.sequence);
+			CHECK(sample.squared == uint64_t(sample.sequence) * sample.sequence);
+			CHECK(int64_t(sample.sequence) > last);
+
+			last = sample.sequence;
+			++result.delivered;
+
+			if (pauseEvery > 0 && sample.sequence % pauseEvery == 0)
+				std::this_thread::sleep_for(std::chrono::microseconds(50));
+		};
+
+		while (! done.load(std::memory_order_acquire))
+		{
+			if (subscriber.drain(check) == 0)
+				std::this_thread::yield();
+		}
+
+		subscriber.drain(check);
+		result.dropped = subscriber.dropped();
+
+		return result;
+	}
+
+	// Run with indices starting at 0 and just before they wrap
+	void test_two_threads(uint32_t firstIndex)
+	{
+		Channel channel(firstIndex);
+		std::atomic<bool> done = false;
+
+		Result fast, slow;
+
+		std::thread fastThread([&] { fast = subscribe(channel, done, 0); });
+		std::thread slowThread([&] { slow = subscribe(channel, done, 1000); });
+
+		// Both subscribers start at the head, give them time to exist before publishing
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		for (uint32_t n = 0; n < kPublishes; n++)
+		{
+			channel.publish(make_sample(n));
+
+			// Roughly the rate of a controller, and lets the subscribers run on a single core
+			if (n % 32 == 0)
+				std::this_thread::yield();
+		}
+
+		done.store(true, std::memory_order_release);
+
+		fastThread.join();
+		slowThread.join();
+
+		std::printf("fast subscriber: %zu delivered, %zu dropped\n", fast.delivered, fast.dropped);
+		std::printf("slow subscriber: %zu delivered, %zu dropped\n", slow.delivered, slow.dropped);
+
+		CHECK(fast.delivered + fast.dropped == kPublishes);
+		CHECK(slow.delivered + slow.dropped == kPublishes);
+
+		// The slow subscriber can't keep up, overruns must be detected rather than delivered
+		CHECK(slow.dropped > 0);
+	}
+
+	void test_overrun_single_thread(uint32_t firstIndex)
+	{
+		Channel channel(firstIndex);
+		Channel::Subscriber subscriber(channel);
+
+		for (uint32_t n = 0; n < kCapacity * 3 + 5; n++)
+			channel.publish(make_sample(n));
+
+		std::vector<uint32_t> delivered;
+		subscriber.drain([&](const Sample& sample) { delivered.push_back(sample.sequence); });
+
+		// Only the newest Capacity samples are left
+		CHECK(delivered.size() == kCapacity);
+		CHECK(delivered.front() == kCapacity * 2 + 5);
+		CHECK(subscriber.dropped() == kCapacity * 2 + 5);
+
+		Sample latest;
+		CHECK(! subscriber.latest(latest));
+
+		channel.publish(make_sample(1000));
+		channel.publish(make_sample(1001));
+		CHECK(subscriber.latest(latest));
+		CHECK(latest.sequence == 1001);
+	}
+
+	// The producer's cost per publish must not depend on how many subscribers are reading
+	void benchmark_producer(int subscribers)
+	{
+		Channel channel;
+		std::atomic<bool> done = false;
+		std::vector<std::thread> threads;
+
+		for (int n = 0; n < subscribers; n++)
+			threads.emplace_back([&] { subscribe(channel, done, 0); });
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+		constexpr uint32_t kBatch = 1000;
+		constexpr uint32_t kBatches = 1000;
+
+		std::vector<double> batchNs;
+		batchNs.reserve(kBatches);
+
+		for (uint32_t batch = 0; batch < kBatches; batch++)
+		{
+			const auto start = Clock::now();
+
+			for (uint32_t n = 0; n < kBatch; n++)
+				channel.publish(make_sample(batch * kBatch + n));
+
+			batchNs.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / kBatch);
+		}
+
+		done.store(true, std::memory_order_release);
+
+		for (auto& thread: threads)
+			thread.join();
+
+		std::sort(batchNs.begin(), batchNs.end());
+
+		std::printf("publish with %d subscribers: median %.1f ns, p99 %.1f ns\n",
+			subscribers, batchNs[kBatches / 2], batchNs[kBatches * 99 / 100]);
+	}
+}
+
+int main()
+{
+	// Wraps within the first Capacity samples, and halfway through the threaded run
+	constexpr uint32_t kNearWrap = UINT32_MAX - kCapacity / 2;
+
+	test_overrun_single_thread(0);
+	test_overrun_single_thread(kNearWrap);
+	test_two_threads(0);
+	test_two_threads(kNearWrap - kPublishes / 2);
+
+	benchmark_producer(0);
+	benchmark_producer(1);
+	benchmark_producer(4);
+
+	return 0;
+}
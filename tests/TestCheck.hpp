@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdio>
+#include <cstdlib>
+
+// Fails the test, printing the condition and where it was checked. Unlike assert() it is kept in
+// release builds, which the benchmarks and stress tests are run as.
+#define CHECK(condition) \
+	do \
+	{ \
+		if (! (condition)) \
+		{ \
+			std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+			std::abort(); \
+		} \
+	} while (false)
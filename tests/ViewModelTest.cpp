@@ -0,0 +1,115 @@
+#include "EspressoViewModel.hpp"
+#include "TestCheck.hpp"
+
+#include <cstring>
+
+// Feeds the widget bindings repeated readings, as the telemetry handlers do while nothing on
+// the machine changes, against fake widgets that count the updates LVGL would redraw. The
+// counters printWidgetStats() reports must match what actually reached the widgets.
+
+namespace
+{
+	constexpr int kRepeats = 100;
+
+	void test_label_skips_unchanged_values()
+	{
+		lv_obj_t label;
+		LabelBinding binding("Temperature gauge", 1, "°c");
+		binding.attach(&label);
+
+		binding.setValue(93.04f);
+		CHECK(std::strcmp(label.text, "93.0°c") == 0);
+
+		for (int n = 0; n < kRepeats; n++)
+			binding.setValue(93.04f);
+
+		CHECK(binding.invalidations() == 1);
+		CHECK(binding.skipped() == kRepeats);
+		CHECK(label.updates == 1);
+
+		// Noise below the displayed resolution changes nothing on screen either
+		binding.setValue(93.01f);
+		binding.setValue(92.96f);
+
+		CHECK(binding.invalidations() == 1);
+		CHECK(binding.skipped() == kRepeats + 2);
+		CHECK(label.updates == 1);
+
+		binding.setValue(93.06f);
+		CHECK(std::strcmp(label.text, "93.1°c") == 0);
+		CHECK(binding.invalidations() == 2);
+		CHECK(label.updates == 2);
+	}
+
+	void test_label_text_and_value()
+	{
+		lv_obj_t label;
+		LabelBinding binding("Weight", 1, "g");
+		binding.attach(&label);
+
+		for (int n = 0; n < kRepeats; n++)
+			binding.setText("---");
+
+		CHECK(std::strcmp(label.text, "---") == 0);
+		CHECK(binding.invalidations() == 1);
+		CHECK(binding.skipped() == kRepeats - 1);
+
+		// Switching between text and a value always redraws, even to the same characters
+		binding.setValue(0.0f);
+		binding.setText("---");
+		binding.setValue(0.0f);
+
+		CHECK(binding.invalidations() == 4);
+		CHECK(binding.skipped() == kRepeats - 1);
+		CHECK(label.updates == 4);
+	}
+
+	void test_needle_skips_unchanged_values()
+	{
+		lv_obj_t meter;
+		lv_meter_indicator_t indicator;
+		NeedleBinding binding("Pressure needle");
+		binding.attach(&meter, &indicator);
+
+		for (int n = 0; n < kRepeats; n++)
+			binding.setValue(180);
+
+		CHECK(meter.value == 180);
+		CHECK(binding.invalidations() == 1);
+		CHECK(binding.skipped() == kRepeats - 1);
+		CHECK(meter.updates == 1);
+
+		binding.setValue(181);
+		CHECK(meter.value == 181);
+		CHECK(binding.invalidations() == 2);
+		CHECK(meter.updates == 2);
+	}
+
+	// A new widget starts out showing nothing the binding knows of
+	void test_attach_redraws()
+	{
+		lv_obj_t first, second;
+		LabelBinding binding("Pressure", 1, " bar");
+
+		binding.attach(&first);
+		binding.setValue(9.0f);
+
+		binding.attach(&second);
+		binding.setValue(9.0f);
+
+		CHECK(first.updates == 1);
+		CHECK(second.updates == 1);
+		CHECK(binding.invalidations() == 2);
+		CHECK(binding.skipped() == 0);
+	}
+}
+
+int main()
+{
+	test_label_skips_unchanged_values();
+	test_label_text_and_value();
+	test_needle_skips_unchanged_values();
+	test_attach_redraws();
+
+	return 0;
+}
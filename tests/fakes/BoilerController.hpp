@@ -0,0 +1,31 @@
+#pragma once
+
+// Host stand-in for the boiler controller component, only what the UI uses of it.
+
+enum class BoilerState
+{
+	Heating,
+	Inhibited,
+	Idle,
+	Ready,
+	Brewing,
+};
+
+struct BoilerTemperatureDelegate
+{
+	virtual void onBoilerCurrentTempChanged(float temp) = 0;
+	virtual void onBoilerTargetTempChanged(float temp) = 0;
+	virtual void onBoilerStateChanged(BoilerState state) = 0;
+	virtual void onBoilerPressureChanged(float pressure) = 0;
+};
+
+class BoilerController
+{
+public:
+	void registerBoilerTemperatureDelegate(BoilerTemperatureDelegate* delegate)
+	{
+		m_delegate = delegate;
+	}
+
+	BoilerTemperatureDelegate* m_delegate = nullptr;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+// Host stand-in for the scales controller component, only what the UI uses of it.
+
+struct ScalesWeightDelegate
+{
+	virtual void onScalesWeightChanged(float weight) = 0;
+};
+
+class ScalesController
+{
+public:
+	void registerWeightDelegate(ScalesWeightDelegate* delegate)
+	{
+		m_delegate = delegate;
+	}
+
+	ScalesWeightDelegate* m_delegate = nullptr;
+};
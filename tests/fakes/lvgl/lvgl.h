@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+
+// Just enough of LVGL for EspressoViewModel on the host. Widgets remember what they were last
+// set to and count the calls that would make LVGL redraw them. Only added to the include path of
+// tests that don't link the real LVGL.
+
+struct lv_obj_t
+{
+	const char* text = nullptr;
+	int32_t value = 0;
+	uint32_t updates = 0;
+};
+
+struct lv_meter_indicator_t
+{
+};
+
+inline void lv_label_set_text_static(lv_obj_t* label, const char* text)
+{
+	label->text = text;
+	++label->updates;
+}
+
+inline void lv_meter_set_indicator_end_value(lv_obj_t* meter, lv_meter_indicator_t*, int32_t value)
+{
+	meter->value = value;
+	++meter->updates;
+}
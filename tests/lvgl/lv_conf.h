@@ -0,0 +1,37 @@
+// LVGL v8 configuration for the host tab tests. Options not set here keep LVGL's defaults.
+
+#ifndef LV_CONF_H
+#define LV_CONF_H
+
+#include <stdint.h>
+
+#define LV_COLOR_DEPTH 16
+
+// LVGL's own allocator, so lv_mem_monitor() sees every allocation the UI makes
+#define LV_MEM_CUSTOM 0
+#define LV_MEM_SIZE (4U * 1024U * 1024U)
+
+#define LV_TICK_CUSTOM 0
+#define LV_DPI_DEF 130
+
+#define LV_USE_LOG 0
+#define LV_USE_ASSERT_NULL 1
+#define LV_USE_ASSERT_MALLOC 1
+#define LV_USE_ASSERT_MEM_INTEGRITY 1
+#define LV_USE_ASSERT_OBJ 1
+
+#define LV_USE_SNAPSHOT 1
+
+#define LV_FONT_MONTSERRAT_8 1
+#define LV_FONT_MONTSERRAT_10 1
+#define LV_FONT_MONTSERRAT_12 1
+#define LV_FONT_MONTSERRAT_14 1
+#define LV_FONT_MONTSERRAT_16 1
+#define LV_FONT_MONTSERRAT_18 1
+#define LV_FONT_MONTSERRAT_20 1
+#define LV_FONT_MONTSERRAT_22 1
+#define LV_FONT_MONTSERRAT_24 1
+#define LV_FONT_MONTSERRAT_28 1
+#define LV_FONT_MONTSERRAT_30 1
+
+#endif
@@ -0,0 +1,179 @@
+#!/usr/bin/env python3
+"""Run-length encodes an LVGL image so it is stored compressed and decoded by EspressoImageDecoder.
+
+The input is a C file from LVGL's image converter in LV_IMG_CF_TRUE_COLOR_ALPHA, holding one block
+of pixels per LV_COLOR_DEPTH. The decoder always produces true colour with alpha, so images without
+alpha are rejected. Each block is compressed on its own and the output keeps the same
+#if structure and image name, so the image is still used with LV_IMG_DECLARE(). The descriptor's
+colour format becomes LV_IMG_CF_RAW_ALPHA, which LVGL's built in decoder leaves to ours.
+
+Stream layout, see EspressoImageDecoder.hpp:
+    "ERLE", bytes per pixel, then packets of a control byte c followed by
+        c < 128:  c + 1 literal pixels
+        c >= 128: one pixel repeated c - 126 times
+
+Prints the raw and compressed size of each block.
+"""
+
+import argparse
+import pathlib
+import re
+import sys
+
+MAGIC = b"ERLE"
+MAX_PACKET = 128
+
+BLOCK_RE = re.compile(r"^#if (LV_COLOR_DEPTH[^\n]*)\n(.*?)^#endif", re.M | re.S)
+BYTE_RE = re.compile(r"0x([0-9a-fA-F]{2})")
+HEADER_RE = re.compile(r"\.header\.(cf|w|h) = (\w+)")
+NAME_RE = re.compile(r"const lv_img_dsc_t (\w+) = \{")
+
+
+def encode(data, pixel_size):
+    pixels = [bytes(data[n:n + pixel_size]) for n in range(0, len(data), pixel_size)]
+    out = bytearray(MAGIC)
+    out.append(pixel_size)
+
+    literals = []
+
+    def flush_literals():
+        while literals:
+            packet = literals[:MAX_PACKET]
+            del literals[:MAX_PACKET]
+            out.append(len(packet) - 1)
+            for pixel in packet:
+                out.extend(pixel)
+
+    n = 0
+    while n < len(pixels):
+        run = 1
+        while n + run < len(pixels) and run < MAX_PACKET + 1 and pixels[n + run] == pixels[n]:
+            run += 1
+
+        # A run of two costs as much as two literals and would split a literal packet
+        if run >= 3:
+            flush_literals()
+            out.append(run + 126)
+            out += pixels[n]
+        else:
+            literals.extend(pixels[n:n + run])
+
+        n += run
+
+    flush_literals()
+    return bytes(out)
+
+
+def decode(stream, pixel_count):
+    pixel_size = stream[4]
+    out = bytearray()
+    n = 5
+
+    while n < len(stream):
+        control = stream[n]
+        n += 1
+
+        if control < 128:
+            length = (control + 1) * pixel_size
+            out += stream[n:n + length]
+            n += length
+        else:
+            out += stream[n:n + pixel_size] * (control - 126)
+            n += pixel_size
+
+    assert len(out) == pixel_count * pixel_size
+    return bytes(out)
+
+
+def c_array(data, indent="  ", per_line=24):
+    lines = []
+    for n in range(0, len(data), per_line):
+        lines.append(indent + ", ".join(f"0x{b:02x}" for b in data[n:n + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("input", type=pathlib.Path, help="C file from LVGL's image converter")
+    parser.add_argument("output", type=pathlib.Path, help="Compressed C file, may be the input")
+    args = parser.parse_args()
+
+    source = args.input.read_text(encoding="utf-8")
+
+    name = NAME_RE.search(source)
+    header = dict(HEADER_RE.findall(source))
+
+    if name is None or {"cf", "w", "h"} - header.keys():
+        sys.exit(f"{args.input}: no image descriptor found")
+
+    if header["cf"] == "LV_IMG_CF_RAW_ALPHA":
+        sys.exit(f"{args.input}: already compressed")
+
+    # EspressoImageDecoder expects LV_IMG_PX_SIZE_ALPHA_BYTE per pixel
+    if header["cf"] != "LV_IMG_CF_TRUE_COLOR_ALPHA":
+        sys.exit(f"{args.input}: {header['cf']} not supported, convert as true colour with alpha")
+
+    name = name.group(1)
+    width, height = int(header["w"]), int(header["h"])
+    pixel_count = width * height
+
+    out = [
+        "// Generated by tools/compress_image.py, do not edit",
+        "",
+        "#if defined(LV_LVGL_H_INCLUDE_SIMPLE)",
+        '#include "lvgl.h"',
+        "#else",
+        '#include "lvgl/lvgl.h"',
+        "#endif",
+        "",
+        "#ifndef LV_ATTRIBUTE_MEM_ALIGN",
+        "#define LV_ATTRIBUTE_MEM_ALIGN",
+        "#endif",
+        "",
+        f"#ifndef LV_ATTRIBUTE_IMG_{name.upper()}",
+        f"#define LV_ATTRIBUTE_IMG_{name.upper()}",
+        "#endif",
+        "",
+    ]
+
+    print(f"{name} {width}x{height}:")
+
+    for condition, body in BLOCK_RE.findall(source):
+        data = bytes(int(b, 16) for b in BYTE_RE.findall(body))
+
+        if len(data) % pixel_count != 0:
+            sys.exit(f"{args.input}: {condition} block is not a whole number of pixels")
+
+        stream = encode(data, len(data) // pixel_count)
+        assert decode(stream, pixel_count) == data
+
+        out += [
+            f"#if {condition.strip()}",
+            f"const LV_ATTRIBUTE_MEM_ALIGN LV_ATTRIBUTE_LARGE_CONST LV_ATTRIBUTE_IMG_{name.upper()} uint8_t {name}_map[] = {{",
+            c_array(stream),
+            "};",
+            "#endif",
+            "",
+        ]
+
+        print(f"  {condition.strip()}: {len(data)} bytes raw, {len(stream)} compressed ({100 * len(stream) // len(data)}%)")
+
+    out += [
+        f"const lv_img_dsc_t {name} = {{",
+        "  .header.cf = LV_IMG_CF_RAW_ALPHA,",
+        "  .header.always_zero = 0,",
+        "  .header.reserved = 0,",
+        f"  .header.w = {width},",
+        f"  .header.h = {height},",
+        f"  .data_size = sizeof({name}_map),",
+        f"  .data = {name}_map,",
+        "};",
+        "",
+    ]
+
+    args.output.write_text("\n".join(out), encoding="utf-8")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,55 @@
+// Converts binary shot logs (.esl) to the CSV layout Logging writes, for reading logs copied off
+// the machine on a desktop. Built by the host project in tests/.
+//
+//	shotlog_to_csv logs/*.esl
+//
+// Each log is written next to itself with a .csv extension, or to -o for a single log.
+
+#include "ShotLogFormat.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+int main(int argc, char** argv)
+{
+	std::vector<std::string> logs;
+	std::string output;
+
+	for (int n = 1; n < argc; n++)
+	{
+		if (std::strcmp(argv[n], "-o") == 0 && n + 1 < argc)
+			output = argv[++n];
+		else
+			logs.emplace_back(argv[n]);
+	}
+
+	if (logs.empty() || (! output.empty() && logs.size() > 1))
+	{
+		std::fprintf(stderr, "Usage: %s [-o out.csv] log.esl [log.esl ...]\n", argv[0]);
+		return 2;
+	}
+
+	int failed = 0;
+
+	for (const auto& log: logs)
+	{
+		const auto csv = output.empty() ? fs::path(log).replace_extension(".csv").string() : output;
+
+		if (ShotLogReader::ConvertToCsv(log, csv))
+		{
+			std::printf("%s -> %s\n", log.c_str(), csv.c_str());
+		}
+		else
+		{
+			std::fprintf(stderr, "%s: not a valid shot log or can't write %s\n", log.c_str(), csv.c_str());
+			++failed;
+		}
+	}
+
+	return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,212 @@
+#!/usr/bin/env python3
+"""Generates Montserrat fonts holding only the glyphs the UI draws.
+
+Every string literal in the UI sources is scanned, printf style conversions count as the
+characters they can print, and a few strings only known at run time are covered by the
+character classes in RUNTIME_CHARSETS. Font sizes and text roles are read from the
+ESPRESSO_FONT() uses in EspressoTheme.cpp. Roles in NUMERIC_ROLES only ever draw numbers LVGL
+formats itself, so a size used by nothing else gets digits only.
+
+Writes one lv_font_conv source per size and EspressoSubsetFonts.h to --out, then checks every
+generated font contains all the glyphs it was asked for. Exits non-zero, failing the CMake
+configure, when a glyph is missing from the TTF or lv_font_conv fails. Prints the glyph count
+and bitmap size of each font against the full ASCII font.
+"""
+
+import argparse
+import pathlib
+import re
+import subprocess
+import sys
+import tempfile
+
+DIGITS = "0123456789"
+
+# Strings put together at run time: the connection screen shows the host name
+RUNTIME_CHARSETS = {
+    "hostname": "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ" + DIGITS + ".-",
+}
+
+# Chart axis and gauge scale labels
+NUMERIC_ROLES = {"Axis", "Scale"}
+NUMERIC_GLYPHS = DIGITS + "-"
+
+FULL_ASCII_RANGE = "0x20-0x7E"
+
+LITERAL_RE = re.compile(r'"((?:[^"\\\n]|\\.)*)"')
+CONVERSION_RE = re.compile(r"%[-+ 0#]*\d*(?:\.\d+)?([a-zA-Z%])")
+FONT_RE = re.compile(r"ESPRESSO_FONT\((\d+)\)")
+ROLE_RE = re.compile(r"init_text\(Text::(\w+),\s*ESPRESSO_FONT\((\d+)\)\)")
+GLYPH_COMMENT_RE = re.compile(r"/\* U\+([0-9A-Fa-f]+) ")
+
+ESCAPES = {"n": "\n", "t": "\t", "\\": "\\", '"': '"', "'": "'", "0": "\0"}
+
+
+def unescape(literal):
+    out = []
+    n = 0
+    while n < len(literal):
+        c = literal[n]
+        if c != "\\":
+            out.append(c)
+            n += 1
+            continue
+        escaped = literal[n + 1]
+        if escaped == "x":
+            match = re.match(r"[0-9A-Fa-f]+", literal[n + 2:])
+            out.append(chr(int(match.group(0), 16)))
+            n += 2 + len(match.group(0))
+        else:
+            out.append(ESCAPES.get(escaped, escaped))
+            n += 2
+    return "".join(out)
+
+
+def expand_conversions(text, source):
+    """Replaces printf conversions with the characters they can produce."""
+    glyphs = set()
+
+    def replace(match):
+        conversion = match.group(1)
+        if conversion == "%":
+            return "%"
+        if conversion in "diufgeEx":
+            glyphs.update(DIGITS + "-." + ("abcdef" if conversion == "x" else ""))
+            return ""
+        if conversion == "s":
+            return ""
+        sys.exit(f"{source}: conversion %{conversion} not handled")
+
+    return CONVERSION_RE.sub(replace, text), glyphs
+
+
+def scan_sources(directory):
+    """Returns {character: first place it is used} for every UI string literal."""
+    used = {}
+
+    for path in sorted(list(directory.glob("*.cpp")) + list(directory.glob("*.hpp"))):
+        for number, line in enumerate(path.read_text(encoding="utf-8").splitlines(), 1):
+            stripped = line.strip()
+
+            # Console output and includes never reach the display
+            if stripped.startswith("#") or stripped.startswith("//") or "printf(" in line:
+                continue
+
+            for literal in LITERAL_RE.findall(line):
+                source = f"{path.name}:{number}"
+                text, glyphs = expand_conversions(unescape(literal), source)
+
+                for c in list(text) + sorted(glyphs):
+                    if c.isprintable():
+                        used.setdefault(c, source)
+
+    for name, charset in RUNTIME_CHARSETS.items():
+        for c in charset:
+            used.setdefault(c, f"runtime {name}")
+
+    return used
+
+
+def font_roles(theme_source):
+    """Returns {size: set of roles}, roles are empty for sizes used outside init_text()."""
+    text = theme_source.read_text(encoding="utf-8")
+    sizes = {int(size): set() for size in FONT_RE.findall(text)}
+    role_uses = {size: 0 for size in sizes}
+
+    # Every display profile's fonts are generated, each profile sets the roles again
+    for role, size in ROLE_RE.findall(text):
+        sizes[int(size)].add(role)
+        role_uses[int(size)] += 1
+
+    # A size also used outside init_text(), e.g. for the theme, draws any text
+    for size in sizes:
+        uses = len(re.findall(rf"ESPRESSO_FONT\({size}\)", text))
+        if uses > role_uses[size]:
+            sizes[size] = set()
+
+    return sizes
+
+
+def font_name(size):
+    return f"espresso_font_montserrat_{size}"
+
+
+def convert(converter, ttf, size, output, symbols=None, char_range=None):
+    command = [converter, "--font", str(ttf), "--size", str(size), "--bpp", "4",
+               "--format", "lvgl", "--no-compress", "--lv-font-name", font_name(size), "-o", str(output)]
+
+    if symbols is not None:
+        command += ["--symbols", symbols]
+    if char_range is not None:
+        command += ["--range", char_range]
+
+    subprocess.run(command, check=True, stdout=subprocess.DEVNULL)
+
+
+def generated_glyphs(source):
+    return {chr(int(code, 16)) for code in GLYPH_COMMENT_RE.findall(source.read_text(encoding="utf-8"))}
+
+
+def bitmap_bytes(source):
+    text = source.read_text(encoding="utf-8")
+    start = text.find("glyph_bitmap[]")
+    end = text.find("};", start)
+    return text.count("0x", start, end)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--sources", type=pathlib.Path, required=True, help="UI source directory")
+    parser.add_argument("--ttf", type=pathlib.Path, required=True, help="Montserrat TTF, e.g. lvgl/scripts/built_in_font/Montserrat-Medium.ttf")
+    parser.add_argument("--out", type=pathlib.Path, required=True, help="Directory for the generated fonts")
+    parser.add_argument("--lv-font-conv", default="lv_font_conv", help="lv_font_conv executable")
+    args = parser.parse_args()
+
+    if not args.ttf.is_file():
+        sys.exit(f"Font {args.ttf} not found, set ESPRESSO_UI_FONT_TTF")
+
+    used = scan_sources(args.sources)
+    sizes = font_roles(args.sources / "EspressoTheme.cpp")
+
+    args.out.mkdir(parents=True, exist_ok=True)
+
+    missing = []
+    report = []
+
+    for size, roles in sorted(sizes.items()):
+        numeric = bool(roles) and roles <= NUMERIC_ROLES
+        wanted = set(NUMERIC_GLYPHS) if numeric else set(used) | {" "}
+
+        output = args.out / f"{font_name(size)}.c"
+        convert(args.lv_font_conv, args.ttf, size, output, symbols="".join(sorted(wanted)))
+
+        for c in sorted(wanted - generated_glyphs(output)):
+            missing.append(f"montserrat {size}: U+{ord(c):04X} {c!r} used at {used.get(c, 'numeric role')}")
+
+        with tempfile.TemporaryDirectory() as temp:
+            baseline = pathlib.Path(temp) / "full.c"
+            convert(args.lv_font_conv, args.ttf, size, baseline, char_range=FULL_ASCII_RANGE)
+            full_glyphs, full_bytes = len(generated_glyphs(baseline)), bitmap_bytes(baseline)
+
+        glyphs, size_bytes = len(generated_glyphs(output)), bitmap_bytes(output)
+        report.append(f"  montserrat {size:2}: {glyphs:3} glyphs, {size_bytes:6} bitmap bytes"
+                      f" (full ASCII {full_glyphs} glyphs, {full_bytes} bytes, {100 - 100 * size_bytes // max(full_bytes, 1)}% saved)"
+                      + (" digits only" if numeric else ""))
+
+    header = ["#pragma once", "", "// Generated by tools/subset_fonts.py, do not edit", "", '#include "lvgl.h"', ""]
+    header += [f"LV_FONT_DECLARE({font_name(size)})" for size in sorted(sizes)]
+    (args.out / "EspressoSubsetFonts.h").write_text("\n".join(header) + "\n", encoding="utf-8")
+
+    print("Subsetted fonts:")
+    print("\n".join(report))
+
+    if missing:
+        print("Glyphs missing from the generated fonts:", file=sys.stderr)
+        print("\n".join("  " + line for line in missing), file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())